@@ -71,6 +71,8 @@ void Error_Handler(void);
 #define USER_LED_GPIO_Port GPIOA
 
 /* USER CODE BEGIN Private defines */
+#define HOST_INT_Pin GPIO_PIN_12
+#define HOST_INT_GPIO_Port GPIOB
 
 /* USER CODE END Private defines */
 
@@ -23,6 +23,7 @@
 /* USER CODE BEGIN Includes */
 #include <stdint.h>
 #include "apps/main_task.h"
+#include "utility/cycle_counter.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -89,7 +90,8 @@ int main(void)
   SystemClock_Config();
 
   /* USER CODE BEGIN SysInit */
-
+  /** enable once, execution time measured by i2c slave, fs_comm and scheduler */
+  cycle_counter_init();
   /* USER CODE END SysInit */
 
   /* Initialize all configured peripherals */
@@ -188,7 +190,15 @@ static void MX_I2C1_Init(void)
     Error_Handler();
   }
   /* USER CODE BEGIN I2C1_Init 2 */
-
+  /* bus speed profile, see. CONFIG_I2C_FAST_MODE */
+  if (hi2c1.Init.ClockSpeed != I2C_SLAVE_CLOCK_SPEED)
+  {
+    hi2c1.Init.ClockSpeed = I2C_SLAVE_CLOCK_SPEED;
+    if (HAL_I2C_Init(&hi2c1) != HAL_OK)
+    {
+      Error_Handler();
+    }
+  }
   /* USER CODE END I2C1_Init 2 */
 
 }
@@ -363,6 +373,14 @@ static void MX_GPIO_Init(void)
   HAL_GPIO_Init(USER_LED_GPIO_Port, &GPIO_InitStruct);
 
 /* USER CODE BEGIN MX_GPIO_Init_2 */
+  /* HOST_INT open drain, released (high) till register change pending */
+  HAL_GPIO_WritePin(HOST_INT_GPIO_Port, HOST_INT_Pin, GPIO_PIN_SET);
+
+  GPIO_InitStruct.Pin = HOST_INT_Pin;
+  GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_OD;
+  GPIO_InitStruct.Pull = GPIO_NOPULL;
+  GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
+  HAL_GPIO_Init(HOST_INT_GPIO_Port, &GPIO_InitStruct);
 /* USER CODE END MX_GPIO_Init_2 */
 }
 
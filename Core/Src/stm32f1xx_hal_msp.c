@@ -21,7 +21,7 @@
 /* Includes ------------------------------------------------------------------*/
 #include "main.h"
 /* USER CODE BEGIN Includes */
-
+#include "drivers/i2c/i2c_slave.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -114,6 +114,7 @@ void HAL_I2C_MspInit(I2C_HandleTypeDef* hi2c)
     HAL_NVIC_SetPriority(I2C1_ER_IRQn, 0, 0);
     HAL_NVIC_EnableIRQ(I2C1_ER_IRQn);
   /* USER CODE BEGIN I2C1_MspInit 1 */
+    i2c_slave_msp_init(hi2c);
 
   /* USER CODE END I2C1_MspInit 1 */
   }
@@ -148,6 +149,7 @@ void HAL_I2C_MspDeInit(I2C_HandleTypeDef* hi2c)
     HAL_NVIC_DisableIRQ(I2C1_EV_IRQn);
     HAL_NVIC_DisableIRQ(I2C1_ER_IRQn);
   /* USER CODE BEGIN I2C1_MspDeInit 1 */
+    i2c_slave_msp_deinit(hi2c);
 
   /* USER CODE END I2C1_MspDeInit 1 */
   }
@@ -23,6 +23,8 @@
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
 #include "drivers/uart/fs_comm.h"
+#include "drivers/i2c/i2c_slave.h"
+#include "utility/low_power.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -184,7 +186,7 @@ void PendSV_Handler(void)
 void SysTick_Handler(void)
 {
   /* USER CODE BEGIN SysTick_IRQn 0 */
-
+  low_power_tick();
   /* USER CODE END SysTick_IRQn 0 */
   HAL_IncTick();
   /* USER CODE BEGIN SysTick_IRQn 1 */
@@ -205,10 +207,12 @@ void SysTick_Handler(void)
 void I2C1_EV_IRQHandler(void)
 {
   /* USER CODE BEGIN I2C1_EV_IRQn 0 */
+  i2c_slave_irq_enter();
 
   /* USER CODE END I2C1_EV_IRQn 0 */
   HAL_I2C_EV_IRQHandler(&hi2c1);
   /* USER CODE BEGIN I2C1_EV_IRQn 1 */
+  i2c_slave_irq_exit();
 
   /* USER CODE END I2C1_EV_IRQn 1 */
 }
@@ -219,10 +223,12 @@ void I2C1_EV_IRQHandler(void)
 void I2C1_ER_IRQHandler(void)
 {
   /* USER CODE BEGIN I2C1_ER_IRQn 0 */
+  i2c_slave_irq_enter();
 
   /* USER CODE END I2C1_ER_IRQn 0 */
   HAL_I2C_ER_IRQHandler(&hi2c1);
   /* USER CODE BEGIN I2C1_ER_IRQn 1 */
+  i2c_slave_irq_exit();
 
   /* USER CODE END I2C1_ER_IRQn 1 */
 }
@@ -241,5 +247,32 @@ void USART1_IRQHandler(void)
 }
 
 /* USER CODE BEGIN 1 */
+#if (FS_UART_USE_DMA)
+/**
+  * @brief This function handles DMA1 channel5 global interrupt (USART1_RX).
+  */
+void DMA1_Channel5_IRQHandler(void)
+{
+  FS_DMA_RX_IRQ_Handler();
+}
+#endif
+
+#if (I2C_SLAVE_USE_DMA)
+/**
+  * @brief This function handles DMA1 channel6 global interrupt (I2C1_TX).
+  */
+void DMA1_Channel6_IRQHandler(void)
+{
+  i2c_slave_dma_tx_irq_handler();
+}
+
+/**
+  * @brief This function handles DMA1 channel7 global interrupt (I2C1_RX).
+  */
+void DMA1_Channel7_IRQHandler(void)
+{
+  i2c_slave_dma_rx_irq_handler();
+}
+#endif
 
 /* USER CODE END 1 */
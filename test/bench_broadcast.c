@@ -0,0 +1,162 @@
+/**
+ * @file bench_broadcast.c
+ * @brief   MCU_MULTI_CIRCULAR_CONTEXT broadcast ring vs
+ *          MCU_DOUBLE_CIRCULAR_CONTEXT (two reader, % wrap) on host
+ *          one stream, each reader get whole stream (parser, trace
+ *          logger, forwarder), burst of chunk put then every reader
+ *          read it back
+ *          copy:  reader copy out (GetData)
+ *          peek:  reader use data in place (Peek / Consume), no copy
+ *          MB/s of stream put, byte sum checked on every reader
+ *          double ring: reader 2 read before reader 1, else lose data
+ *          multi ring: reader read in any order
+ */
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "test_util.h"
+#include "utility/circular_buffer.h"
+
+int test_failed;
+
+#define RING_LEN        512
+#define BENCH_TOTAL     (32UL << 20)
+#define BURST           3           /** chunk put before read back, double
+                                     * ring never full (full read as empty) */
+
+static uint8_t ring_mem[RING_LEN];
+static uint8_t src[256], dst[256];
+static uint32_t src_sum;
+
+static double now_s(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint32_t byte_sum(const uint8_t *p, uint32_t n)
+{
+    uint32_t s = 0;
+
+    while (n--)
+        s += *p++;
+    return s;
+}
+
+static double bench_double(uint16_t chunk)
+{
+    MCU_DOUBLE_CIRCULAR_CONTEXT ring;
+    uint32_t done = 0, sum1 = 0, sum2 = 0, n;
+    double t;
+    int i;
+
+    MCUDCircular_Config(&ring, ring_mem, RING_LEN);
+    t = now_s();
+    while (done < BENCH_TOTAL)
+    {
+        for (i = 0; i < BURST; i++)
+            MCUDCircular_PutData(&ring, src, chunk);
+        /** reader 2 first, R2 moved up to R1 when reader 1 pass it */
+        for (i = 0; i < BURST; i++)
+        {
+            n = MCUDCircular_GetData2(&ring, dst, chunk);
+            sum2 += byte_sum(dst, n);
+        }
+        for (i = 0; i < BURST; i++)
+        {
+            n = MCUDCircular_GetData1(&ring, dst, chunk);
+            sum1 += byte_sum(dst, n);
+            done += n;
+        }
+    }
+    t = now_s() - t;
+
+    CHECK_EQ(sum1, src_sum * (done / chunk));
+    CHECK_EQ(sum2, sum1);
+    return done / t / 1e6;
+}
+
+static double bench_multi_copy(uint16_t chunk, uint8_t readers)
+{
+    MCU_MULTI_CIRCULAR_CONTEXT ring;
+    uint32_t done = 0, sum[MCU_MCIRCULAR_READER_MAX] = { 0 }, n;
+    double t;
+    uint8_t r;
+    int i;
+
+    MCUMCircular_Config(&ring, ring_mem, RING_LEN, readers);
+    t = now_s();
+    while (done < BENCH_TOTAL)
+    {
+        for (i = 0; i < BURST; i++)
+            done += MCUMCircular_PutData(&ring, src, chunk);
+        for (r = 0; r < readers; r++)
+        {
+            for (i = 0; i < BURST; i++)
+            {
+                n = MCUMCircular_GetData(&ring, r, dst, chunk);
+                sum[r] += byte_sum(dst, n);
+            }
+        }
+    }
+    t = now_s() - t;
+
+    for (r = 0; r < readers; r++)
+        CHECK_EQ(sum[r], src_sum * (done / chunk));
+    return done / t / 1e6;
+}
+
+static double bench_multi_peek(uint16_t chunk, uint8_t readers)
+{
+    MCU_MULTI_CIRCULAR_CONTEXT ring;
+    MCU_CIRCULAR_SPAN span;
+    uint32_t done = 0, sum[MCU_MCIRCULAR_READER_MAX] = { 0 }, n;
+    double t;
+    uint8_t r;
+    int i;
+
+    MCUMCircular_Config(&ring, ring_mem, RING_LEN, readers);
+    t = now_s();
+    while (done < BENCH_TOTAL)
+    {
+        for (i = 0; i < BURST; i++)
+            done += MCUMCircular_PutData(&ring, src, chunk);
+        for (r = 0; r < readers; r++)
+        {
+            n = MCUMCircular_Peek(&ring, r, &span);
+            sum[r] += byte_sum(span.Ptr[0], span.Len[0]) + byte_sum(span.Ptr[1], span.Len[1]);
+            MCUMCircular_Consume(&ring, r, n);
+        }
+    }
+    t = now_s() - t;
+
+    for (r = 0; r < readers; r++)
+        CHECK_EQ(sum[r], src_sum * (done / chunk));
+    return done / t / 1e6;
+}
+
+int main(void)
+{
+    static const uint16_t chunk[] = { 1, 8, 64, 128 };
+    unsigned i;
+
+    for (i = 0; i < sizeof(src); i++)
+        src[i] = i;
+
+    printf("  MB/s    double      multi      multi      multi      multi\n");
+    printf("  chunk   2 copy      2 copy     2 peek     3 peek     4 peek\n");
+    for (i = 0; i < sizeof(chunk) / sizeof(chunk[0]); i++)
+    {
+        src_sum = byte_sum(src, chunk[i]);
+        printf("  %5u   %8.1f   %8.1f   %8.1f   %8.1f   %8.1f\n", chunk[i],
+               bench_double(chunk[i]),
+               bench_multi_copy(chunk[i], 2),
+               bench_multi_peek(chunk[i], 2),
+               bench_multi_peek(chunk[i], 3),
+               bench_multi_peek(chunk[i], 4));
+    }
+
+    return TEST_RESULT();
+}
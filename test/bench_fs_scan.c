@@ -0,0 +1,243 @@
+/**
+ * @file bench_fs_scan.c
+ * @brief   fs_comm_scan_data() throughput on host, Venice X byte stream fed
+ *          to receive ring in chunk (as IDLE / DMA half transfer update)
+ *          and parsed until buffer empty
+ *
+ *          test/build/bench_fs_scan [capture]
+ *          capture: raw uart byte recorded from module, replayed as is
+ *          stream:  status    back to back status reply (FS_HEADER3)
+ *                   extended  extended frame with checksum (FS_HEADER3_EXT)
+ *                   fuzzed    valid frame mixed with noise, false header,
+ *                             bad length and bad checksum
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "test_util.h"
+#include "drivers/uart/fs_comm.h"
+#include "utility/crc.h"
+
+int test_failed;
+
+#define STREAM_LEN      (1 << 20)
+#define CHUNK_LEN       64          /** byte per ring update */
+#define BENCH_ROUND     20
+
+static uint8_t stream[STREAM_LEN];
+
+static uint32_t put_status(uint8_t *p)
+{
+    p[0] = FS_HEADER1;
+    p[1] = FS_HEADER2;
+    p[2] = FS_HEADER3;
+    p[3] = FS_SYSTEM_STATUS_DATA_LEN;
+    p[4] = 0x11;
+    p[5] = 0x32;
+    p[6] = rand() & 0x1F;
+    p[7] = 0x00;
+    return FS_HEADER_LEN + FS_SYSTEM_STATUS_DATA_LEN;
+}
+
+static uint32_t put_extended(uint8_t *p, uint8_t len)
+{
+    uint16_t crc;
+    uint8_t i;
+
+    p[0] = FS_HEADER1;
+    p[1] = FS_HEADER2;
+    p[2] = FS_HEADER3_EXT;
+    p[3] = len;
+    for (i = 0; i < len; i++)
+        p[FS_HEADER_LEN + i] = rand();
+    crc = crc16(CRC16_INIT, &p[3], 1 + len);
+    p[FS_HEADER_LEN + len] = crc >> 8;
+    p[FS_HEADER_LEN + len + 1] = crc & 0xFF;
+    return FS_HEADER_LEN + len + FS_CRC_LEN;
+}
+
+/** build stream, return length, *frames: valid frame on stream */
+static uint32_t build_status(uint32_t *frames)
+{
+    uint32_t n = 0;
+
+    *frames = 0;
+    while (n + FS_HEADER_LEN + FS_SYSTEM_STATUS_DATA_LEN <= STREAM_LEN)
+    {
+        n += put_status(&stream[n]);
+        (*frames)++;
+    }
+    return n;
+}
+
+static uint32_t build_extended(uint32_t *frames)
+{
+    uint32_t n = 0;
+    uint8_t len;
+
+    *frames = 0;
+    for (;;)
+    {
+        len = 4 + (rand() % 60);
+        if (n + FS_HEADER_LEN + len + FS_CRC_LEN > STREAM_LEN)
+            break;
+        n += put_extended(&stream[n], len);
+        (*frames)++;
+    }
+    return n;
+}
+
+static uint32_t build_fuzzed(uint32_t *frames)
+{
+    uint32_t n = 0, i, len;
+
+    *frames = 0;
+    while (n + 512 <= STREAM_LEN)
+    {
+        switch (rand() % 6)
+        {
+            case 0:
+                n += put_status(&stream[n]);
+                (*frames)++;
+                break;
+
+            case 1:
+                n += put_extended(&stream[n], 1 + rand() % 120);
+                (*frames)++;
+                break;
+
+            case 2:
+                /** noise, 0xFF dense */
+                len = 1 + rand() % 32;
+                for (i = 0; i < len; i++)
+                    stream[n + i] = (rand() & 1) ? FS_HEADER1 : rand();
+                n += len;
+                break;
+
+            case 3:
+                /** false header, length zero or too long for status */
+                n += put_status(&stream[n]);
+                stream[n - 5] = (rand() & 1) ? 0 : FS_SYSTEM_STATUS_DATA_LEN + 1;
+                break;
+
+            case 4:
+                /** bad checksum */
+                len = put_extended(&stream[n], 1 + rand() % 120);
+                stream[n + len - 1] ^= 0x5A;
+                n += len;
+                break;
+
+            default:
+                /** header cut by noise */
+                stream[n++] = FS_HEADER1;
+                stream[n++] = FS_HEADER2;
+                stream[n++] = rand();
+                break;
+        }
+    }
+    return n;
+}
+
+static uint32_t load_capture(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    uint32_t n;
+
+    if (!f) return 0;
+    n = fread(stream, 1, STREAM_LEN, f);
+    fclose(f);
+    return n;
+}
+
+static void ring_reset(void)
+{
+    memset(&FS, 0, sizeof(FS));
+    timer_wheel_init();
+    MCUCircular_Config(&FS.cbCtx, FS.circular_buffer, FS_CIRCULAR_BUFF_LEN);
+}
+
+/** feed whole stream, return frame parsed */
+static uint32_t run_stream(uint32_t len)
+{
+    uint32_t pos = 0, frames = 0, chunk;
+
+    while (pos < len)
+    {
+        chunk = len - pos;
+        if (chunk > CHUNK_LEN) chunk = CHUNK_LEN;
+        if (chunk > (uint32_t) MCUCircular_GetSpaceLen(&FS.cbCtx))
+            chunk = MCUCircular_GetSpaceLen(&FS.cbCtx);
+
+        MCUCircular_PutData(&FS.cbCtx, &stream[pos], chunk);
+        pos += chunk;
+
+        while (fs_comm_scan_data())
+            frames++;
+    }
+
+    return frames;
+}
+
+static double now_s(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void bench(const char *name, uint32_t len, uint32_t expect)
+{
+    uint32_t frames = 0;
+    double t;
+    int r;
+
+    ring_reset();
+    frames = run_stream(len);
+    if (expect)
+        CHECK_EQ(frames, expect);
+
+    t = now_s();
+    for (r = 0; r < BENCH_ROUND; r++)
+    {
+        ring_reset();
+        run_stream(len);
+    }
+    t = now_s() - t;
+
+    printf("  %-9s %8u byte %7u frame  %10.0f frame/s  %7.1f MB/s  crc err %u discard %u\n",
+           name, (unsigned) len, (unsigned) frames,
+           frames * (double) BENCH_ROUND / t, len * (double) BENCH_ROUND / t / 1e6,
+           (unsigned) FS.rx_crc_error, (unsigned) FS.rx_discard);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t len, frames;
+
+    srand(1);
+
+    if (argc > 1)
+    {
+        len = load_capture(argv[1]);
+        if (!len)
+        {
+            printf("cannot read capture %s\n", argv[1]);
+            return 1;
+        }
+        bench("capture", len, 0);
+        return TEST_RESULT();
+    }
+
+    len = build_status(&frames);
+    bench("status", len, frames);
+
+    len = build_extended(&frames);
+    bench("extended", len, frames);
+
+    len = build_fuzzed(&frames);
+    bench("fuzzed", len, frames);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,138 @@
+/**
+ * @file bench_ring.c
+ * @brief   MCU_CIRCULAR_CONTEXT throughput vs previous implementation
+ *          (legacy/circular_buffer_legacy.c, % wrap, no barrier)
+ *          single thread: burst of chunk put, then same got back
+ *          two thread: producer / consumer, current ring only (legacy
+ *          ring not safe across thread, R == W when full)
+ */
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "test_util.h"
+#include "utility/circular_buffer.h"
+#include "legacy/circular_buffer_legacy.h"
+
+int test_failed;
+
+#define RING_LEN        512
+#define BENCH_TOTAL     (64UL << 20)
+#define BURST           3           /** chunk put before read back, legacy
+                                     * ring never full (full read as empty) */
+
+static uint8_t ring_mem[RING_LEN];
+static uint8_t src[256], dst[256];
+
+static double now_s(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static double bench_current(uint16_t chunk)
+{
+    MCU_CIRCULAR_CONTEXT ring;
+    uint32_t done = 0;
+    double t;
+    int i;
+
+    MCUCircular_Config(&ring, ring_mem, RING_LEN);
+    t = now_s();
+    while (done < BENCH_TOTAL)
+    {
+        for (i = 0; i < BURST; i++)
+            MCUCircular_PutData(&ring, src, chunk);
+        for (i = 0; i < BURST; i++)
+            done += MCUCircular_GetData(&ring, dst, chunk);
+    }
+    return BENCH_TOTAL / (now_s() - t) / 1e6;
+}
+
+static double bench_legacy(uint16_t chunk)
+{
+    LEGACY_CIRCULAR_CONTEXT ring;
+    uint32_t done = 0;
+    double t;
+    int i;
+
+    LegacyCircular_Config(&ring, ring_mem, RING_LEN);
+    t = now_s();
+    while (done < BENCH_TOTAL)
+    {
+        for (i = 0; i < BURST; i++)
+            LegacyCircular_PutData(&ring, src, chunk);
+        for (i = 0; i < BURST; i++)
+            done += LegacyCircular_GetData(&ring, dst, chunk);
+    }
+    return BENCH_TOTAL / (now_s() - t) / 1e6;
+}
+
+static MCU_CIRCULAR_CONTEXT shared;
+static uint16_t shared_chunk;
+
+static void *producer(void *arg)
+{
+    uint32_t done = 0, n;
+
+    while (done < BENCH_TOTAL)
+    {
+        n = MCUCircular_PutData(&shared, src, shared_chunk);
+        if (n == 0) sched_yield();
+        done += n;
+    }
+    return NULL;
+}
+
+static void *consumer(void *arg)
+{
+    uint32_t done = 0, n;
+
+    while (done < BENCH_TOTAL)
+    {
+        n = MCUCircular_GetData(&shared, dst, shared_chunk);
+        if (n == 0) sched_yield();
+        done += n;
+    }
+    return NULL;
+}
+
+static double bench_two_thread(uint16_t chunk)
+{
+    pthread_t p, c;
+    double t;
+
+    MCUCircular_Config(&shared, ring_mem, RING_LEN);
+    shared_chunk = chunk;
+
+    t = now_s();
+    pthread_create(&c, NULL, consumer, NULL);
+    pthread_create(&p, NULL, producer, NULL);
+    pthread_join(p, NULL);
+    pthread_join(c, NULL);
+    return BENCH_TOTAL / (now_s() - t) / 1e6;
+}
+
+int main(void)
+{
+    static const uint16_t chunk[] = { 1, 8, 64, 128 };
+    double cur, leg;
+    unsigned i;
+
+    for (i = 0; i < sizeof(src); i++)
+        src[i] = i;
+
+    printf("  chunk   current MB/s   legacy MB/s   ratio   two thread MB/s\n");
+    for (i = 0; i < sizeof(chunk) / sizeof(chunk[0]); i++)
+    {
+        cur = bench_current(chunk[i]);
+        leg = bench_legacy(chunk[i]);
+        printf("  %5u   %12.1f   %11.1f   %5.2f   %15.1f\n",
+               chunk[i], cur, leg, cur / leg, bench_two_thread(chunk[i]));
+    }
+
+    return TEST_RESULT();
+}
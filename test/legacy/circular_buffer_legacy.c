@@ -0,0 +1,111 @@
+/**
+ * @file circular_buffer_legacy.c
+ * @brief   MCUCircular ring before power of 2 / SPSC rework, kept for
+ *          host benchmark only (see. bench_ring.c), symbol renamed
+ *          MCUCircular_ -> LegacyCircular_, body unchanged
+ *          % wrap, R == W both empty and full, no barrier
+ */
+#include <string.h>
+#include "circular_buffer_legacy.h"
+
+void LegacyCircular_Config(LEGACY_CIRCULAR_CONTEXT* CircularBuf, void* Buf, uint32_t Len)
+{
+    CircularBuf->CircularBuf = Buf;
+    CircularBuf->BufDepth = Len;
+    CircularBuf->R = 0;
+    CircularBuf->W = 0;
+}
+
+int32_t LegacyCircular_GetSpaceLen(LEGACY_CIRCULAR_CONTEXT* CircularBuf)
+{
+	if(CircularBuf->R == CircularBuf->W)
+	{
+		return CircularBuf->BufDepth;
+	}
+	else
+	{
+		return (CircularBuf->BufDepth + CircularBuf->R - CircularBuf->W) % CircularBuf->BufDepth;
+	}   
+}
+
+void LegacyCircular_PutData(LEGACY_CIRCULAR_CONTEXT* CircularBuf, void* InBuf, uint16_t Len)
+{
+    if(Len == 0)
+	{
+		return;
+	}
+	if(CircularBuf->W + Len <= CircularBuf->BufDepth)
+    {
+        memcpy((void *)&CircularBuf->CircularBuf[CircularBuf->W], InBuf, Len);
+    }
+    else
+    {
+        memcpy((void *)&CircularBuf->CircularBuf[CircularBuf->W], InBuf, CircularBuf->BufDepth - CircularBuf->W);
+        memcpy((void *)&CircularBuf->CircularBuf[0], (uint8_t*)InBuf + CircularBuf->BufDepth - CircularBuf->W, CircularBuf->W + Len - CircularBuf->BufDepth);
+    }
+    CircularBuf->W = (CircularBuf->W + Len) % CircularBuf->BufDepth;    
+}
+
+uint16_t LegacyCircular_GetDataLen(LEGACY_CIRCULAR_CONTEXT* CircularBuf)
+{
+	uint16_t R, W;
+	uint16_t Len;
+
+	R = CircularBuf->R;
+	W = CircularBuf->W;
+
+	if(R == W)
+	{
+		return 0;
+	}
+	else if(R < W)
+	{
+		Len = W - R;
+	}
+	else
+	{
+		Len = CircularBuf->BufDepth + W - R;
+	}
+
+	return Len;
+}
+
+
+int32_t LegacyCircular_GetData(LEGACY_CIRCULAR_CONTEXT* CircularBuf, void* OutBuf, uint16_t MaxLen)
+{
+    uint16_t R;//, W;
+    uint16_t Len;
+    
+
+	if(MaxLen == 0)
+	{
+		return 0;
+	}
+
+	R = CircularBuf->R;
+//	W = CircularBuf->W;
+
+	Len = LegacyCircular_GetDataLen(CircularBuf);
+
+    if(Len > MaxLen)
+    {
+        Len = MaxLen;
+    }
+    
+    if(Len + R > CircularBuf->BufDepth)
+    {
+        memcpy(OutBuf, (void *)&CircularBuf->CircularBuf[CircularBuf->R], CircularBuf->BufDepth - CircularBuf->R);
+        memcpy((uint8_t* )OutBuf + CircularBuf->BufDepth - R, (void *)&CircularBuf->CircularBuf[0], Len + R - CircularBuf->BufDepth);
+    }
+    else
+    {
+        memcpy(OutBuf, (void *)&CircularBuf->CircularBuf[CircularBuf->R], Len);
+    }
+    
+    R = (R + Len) % CircularBuf->BufDepth;
+    
+    CircularBuf->R = R;
+        
+    return Len;
+}
+
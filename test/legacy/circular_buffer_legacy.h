@@ -0,0 +1,29 @@
+/**
+ * @file circular_buffer_legacy.h
+ * @brief   MCUCircular ring before power of 2 / SPSC rework, host benchmark
+ *          only, see. circular_buffer_legacy.c
+ */
+#ifndef CIRCULAR_BUFFER_LEGACY_H
+#define CIRCULAR_BUFFER_LEGACY_H
+
+#include <stdint.h>
+
+typedef struct
+{
+    uint32_t    R;
+    uint32_t    W;
+    uint32_t    BufDepth;
+    int8_t*     CircularBuf;
+} LEGACY_CIRCULAR_CONTEXT;
+
+void LegacyCircular_Config(LEGACY_CIRCULAR_CONTEXT* CircularBuf, void* Buf, uint32_t Len);
+
+int32_t LegacyCircular_GetSpaceLen(LEGACY_CIRCULAR_CONTEXT* CircularBuf);
+
+void LegacyCircular_PutData(LEGACY_CIRCULAR_CONTEXT* CircularBuf, void* InBuf, uint16_t Len);
+
+int32_t LegacyCircular_GetData(LEGACY_CIRCULAR_CONTEXT* CircularBuf, void* OutBuf, uint16_t MaxLen);
+
+uint16_t LegacyCircular_GetDataLen(LEGACY_CIRCULAR_CONTEXT* CircularBuf);
+
+#endif /*CIRCULAR_BUFFER_LEGACY_H*/
@@ -0,0 +1,126 @@
+/**
+ * @file hal_stub.c
+ * @brief   host fake of HAL / CMSIS peripheral used by user/ module
+ *          state kept on stub_xxx variable, set and checked by test
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "main.h"
+
+uint32_t stub_primask;
+DWT_Type stub_dwt;
+CoreDebug_Type stub_core_debug;
+uint32_t SystemCoreClock = 72000000;
+volatile uint32_t uwTick;
+uint32_t uwTickFreq = 1;
+SysTick_Type stub_systick;
+SCB_Type stub_scb;
+GPIO_TypeDef stub_gpiob = { 0xFFFFFFFF };
+Stub_I2C_t stub_i2c;
+USART_TypeDef stub_usart1 = { USART_SR_TXE | USART_SR_TC };
+DMA_TypeDef stub_dma1;
+
+uint32_t HAL_GetTick(void)
+{
+    return uwTick;
+}
+
+/** one tick elapsed in sleep */
+void __WFI(void)
+{
+    uwTick += uwTickFreq;
+}
+
+void Error_Handler(void)
+{
+    fprintf(stderr, "Error_Handler\n");
+    exit(1);
+}
+
+void HAL_GPIO_Init(GPIO_TypeDef *port, GPIO_InitTypeDef *init)
+{
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *port, uint16_t pin, GPIO_PinState state)
+{
+    if (state == GPIO_PIN_SET)
+        port->odr |= pin;
+    else
+        port->odr &= ~pin;
+}
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *port, uint16_t pin)
+{
+    return (port->odr & pin) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef *hdma)
+{
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA_DeInit(DMA_HandleTypeDef *hdma)
+{
+    return HAL_OK;
+}
+
+void HAL_DMA_IRQHandler(DMA_HandleTypeDef *hdma)
+{
+}
+
+HAL_StatusTypeDef HAL_I2C_Init(I2C_HandleTypeDef *hi2c)
+{
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_DeInit(I2C_HandleTypeDef *hi2c)
+{
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_EnableListen_IT(I2C_HandleTypeDef *hi2c)
+{
+    stub_i2c.listen++;
+    return HAL_OK;
+}
+
+uint32_t HAL_I2C_GetError(I2C_HandleTypeDef *hi2c)
+{
+    return hi2c->ErrorCode;
+}
+
+HAL_StatusTypeDef HAL_I2C_Slave_Seq_Receive_DMA(I2C_HandleTypeDef *hi2c, uint8_t *data, uint16_t size, uint32_t options)
+{
+    stub_i2c.rx_buf = data;
+    stub_i2c.rx_size = size;
+    stub_i2c.rx_arm++;
+    if (hi2c->hdmarx)
+        hi2c->hdmarx->counter = size;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_Slave_Seq_Transmit_DMA(I2C_HandleTypeDef *hi2c, uint8_t *data, uint16_t size, uint32_t options)
+{
+    stub_i2c.tx_buf = data;
+    stub_i2c.tx_size = size;
+    stub_i2c.tx_arm++;
+    if (hi2c->hdmatx)
+        hi2c->hdmatx->counter = size;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_Slave_Sequential_Receive_IT(I2C_HandleTypeDef *hi2c, uint8_t *data, uint16_t size, uint32_t options)
+{
+    stub_i2c.rx_buf = data;
+    stub_i2c.rx_size = size;
+    stub_i2c.rx_arm++;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_Slave_Seq_Transmit_IT(I2C_HandleTypeDef *hi2c, uint8_t *data, uint16_t size, uint32_t options)
+{
+    stub_i2c.tx_buf = data;
+    stub_i2c.tx_size = size;
+    stub_i2c.tx_arm++;
+    return HAL_OK;
+}
@@ -0,0 +1,28 @@
+/**
+ * @file led_stub.c
+ * @brief   host fake of ws2812 LED animation (ui/led_indicator), no SPI
+ *          on host, application code call it as on target
+ */
+#include "main.h"
+#include "ui/led_indicator/Animation_Style.h"
+#include "ui/led_indicator/led_animation.h"
+
+DisplayProperty_t dispProp;
+uint8_t stub_visual_mode;
+
+void led_animation_init(void)
+{
+}
+
+void led_animation_handler(void)
+{
+}
+
+void set_visual_mode(uint8_t vmode)
+{
+    stub_visual_mode = vmode;
+}
+
+void led_host_frame_commit(const uint8_t *rgb, uint8_t active)
+{
+}
@@ -0,0 +1,309 @@
+/**
+ * @file main.h
+ * @brief   host stub of Core/Inc/main.h for test build (see. test/Makefile)
+ *          CMSIS core, HAL and LL used by user/ module, peripheral
+ *          replaced by fake on hal_stub.c, driven by test
+ */
+#ifndef MAIN_H
+#define MAIN_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define __IO    volatile
+
+/** CMSIS core */
+extern uint32_t stub_primask;
+
+/** DMB used for SPSC index / data order only, acquire + release fence
+ * enough (full fence on x86 cost far more than DMB on Cortex-M3)
+ */
+static inline void __DMB(void) { __atomic_thread_fence(__ATOMIC_ACQ_REL); }
+static inline void __DSB(void) { __sync_synchronize(); }
+static inline void __disable_irq(void) { stub_primask = 1; }
+static inline void __enable_irq(void) { stub_primask = 0; }
+static inline uint32_t __get_PRIMASK(void) { return stub_primask; }
+static inline void __set_PRIMASK(uint32_t primask) { stub_primask = primask; }
+
+typedef struct
+{
+    volatile uint32_t CTRL;
+    volatile uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct
+{
+    volatile uint32_t DEMCR;
+} CoreDebug_Type;
+
+extern DWT_Type stub_dwt;
+extern CoreDebug_Type stub_core_debug;
+#define DWT                         (&stub_dwt)
+#define CoreDebug                   (&stub_core_debug)
+#define DWT_CTRL_CYCCNTENA_Msk      (1UL << 0)
+#define CoreDebug_DEMCR_TRCENA_Msk  (1UL << 24)
+
+typedef struct
+{
+    volatile uint32_t CTRL;
+    volatile uint32_t LOAD;
+    volatile uint32_t VAL;
+} SysTick_Type;
+
+typedef struct
+{
+    volatile uint32_t ICSR;
+} SCB_Type;
+
+extern SysTick_Type stub_systick;
+extern SCB_Type stub_scb;
+#define SysTick                     (&stub_systick)
+#define SCB                         (&stub_scb)
+#define SysTick_CTRL_ENABLE_Msk     (1UL << 0)
+#define SysTick_CTRL_COUNTFLAG_Msk  (1UL << 16)
+#define SysTick_LOAD_RELOAD_Msk     (0xFFFFFFUL)
+#define SCB_ICSR_PENDSTSET_Msk      (1UL << 26)
+#define SCB_ICSR_PENDSTCLR_Msk      (1UL << 25)
+
+/** sleep until interrupt, see. hal_stub.c */
+void __WFI(void);
+
+extern uint32_t SystemCoreClock;
+
+/** HAL */
+typedef enum
+{
+    HAL_OK = 0,
+    HAL_ERROR,
+} HAL_StatusTypeDef;
+
+extern volatile uint32_t uwTick;
+extern uint32_t uwTickFreq;
+uint32_t HAL_GetTick(void);
+void Error_Handler(void);
+
+/** GPIO */
+typedef struct
+{
+    uint32_t Pin;
+    uint32_t Mode;
+    uint32_t Pull;
+    uint32_t Speed;
+} GPIO_InitTypeDef;
+
+typedef enum
+{
+    GPIO_PIN_RESET = 0,
+    GPIO_PIN_SET,
+} GPIO_PinState;
+
+typedef struct { uint32_t odr; } GPIO_TypeDef;
+extern GPIO_TypeDef stub_gpiob;
+#define GPIOB                   (&stub_gpiob)
+#define GPIO_PIN_6              (1U << 6)
+#define GPIO_PIN_7              (1U << 7)
+#define GPIO_PIN_12             (1U << 12)
+#define GPIO_MODE_OUTPUT_OD     0x11U
+#define GPIO_NOPULL             0U
+#define GPIO_SPEED_FREQ_HIGH    3U
+
+/** board pin (see. Core/Inc/main.h), all on stub GPIOB */
+#define USER_LED_Pin            GPIO_PIN_7
+#define USER_LED_GPIO_Port      GPIOB
+#define HOST_INT_Pin            GPIO_PIN_12
+#define HOST_INT_GPIO_Port      GPIOB
+
+void HAL_GPIO_Init(GPIO_TypeDef *port, GPIO_InitTypeDef *init);
+void HAL_GPIO_WritePin(GPIO_TypeDef *port, uint16_t pin, GPIO_PinState state);
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *port, uint16_t pin);
+
+/** SPI, LED driver only declared on host */
+typedef struct { void *Instance; } SPI_HandleTypeDef;
+
+/** DMA */
+typedef struct
+{
+    uint32_t Direction;
+    uint32_t PeriphInc;
+    uint32_t MemInc;
+    uint32_t PeriphDataAlignment;
+    uint32_t MemDataAlignment;
+    uint32_t Mode;
+    uint32_t Priority;
+} DMA_InitTypeDef;
+
+typedef struct
+{
+    void *Instance;
+    DMA_InitTypeDef Init;
+    uint32_t counter;           // remaining transfer, see. __HAL_DMA_GET_COUNTER
+} DMA_HandleTypeDef;
+
+#define DMA1_Channel6           ((void *) 6)
+#define DMA1_Channel7           ((void *) 7)
+#define DMA_PERIPH_TO_MEMORY    0U
+#define DMA_MEMORY_TO_PERIPH    1U
+#define DMA_PINC_DISABLE        0U
+#define DMA_MINC_ENABLE         1U
+#define DMA_PDATAALIGN_BYTE     0U
+#define DMA_MDATAALIGN_BYTE     0U
+#define DMA_NORMAL              0U
+#define DMA_PRIORITY_HIGH       2U
+#define __HAL_DMA_GET_COUNTER(h)    ((h)->counter)
+#define __HAL_RCC_DMA1_CLK_ENABLE() do {} while (0)
+#define __HAL_LINKDMA(h, field, dma)    do { (h)->field = &(dma); } while (0)
+
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef *hdma);
+HAL_StatusTypeDef HAL_DMA_DeInit(DMA_HandleTypeDef *hdma);
+void HAL_DMA_IRQHandler(DMA_HandleTypeDef *hdma);
+
+/** NVIC */
+typedef enum
+{
+    DMA1_Channel5_IRQn = 15,
+    DMA1_Channel6_IRQn = 16,
+    DMA1_Channel7_IRQn = 17,
+} IRQn_Type;
+
+#define HAL_NVIC_SetPriority(irq, pre, sub)     do {} while (0)
+#define HAL_NVIC_EnableIRQ(irq)                 do {} while (0)
+#define HAL_NVIC_DisableIRQ(irq)                do {} while (0)
+
+/** I2C */
+typedef struct
+{
+    uint32_t ClockSpeed;
+} I2C_InitTypeDef;
+
+typedef struct
+{
+    void *Instance;
+    I2C_InitTypeDef Init;
+    DMA_HandleTypeDef *hdmarx;
+    DMA_HandleTypeDef *hdmatx;
+    uint32_t ErrorCode;
+} I2C_HandleTypeDef;
+
+#define I2C_DIRECTION_RECEIVE       0x00000000U
+#define I2C_DIRECTION_TRANSMIT      0x00000001U
+#define I2C_FIRST_FRAME             0x00000000U
+#define I2C_NEXT_FRAME              0x01000000U
+#define I2C_FIRST_AND_LAST_FRAME    0x02000000U
+#define I2C_LAST_FRAME              0x03000000U
+#define HAL_I2C_ERROR_BERR          0x00000001U
+#define HAL_I2C_ERROR_AF            0x00000004U
+
+HAL_StatusTypeDef HAL_I2C_Init(I2C_HandleTypeDef *hi2c);
+HAL_StatusTypeDef HAL_I2C_DeInit(I2C_HandleTypeDef *hi2c);
+HAL_StatusTypeDef HAL_I2C_EnableListen_IT(I2C_HandleTypeDef *hi2c);
+uint32_t HAL_I2C_GetError(I2C_HandleTypeDef *hi2c);
+HAL_StatusTypeDef HAL_I2C_Slave_Seq_Receive_DMA(I2C_HandleTypeDef *hi2c, uint8_t *data, uint16_t size, uint32_t options);
+HAL_StatusTypeDef HAL_I2C_Slave_Seq_Transmit_DMA(I2C_HandleTypeDef *hi2c, uint8_t *data, uint16_t size, uint32_t options);
+HAL_StatusTypeDef HAL_I2C_Slave_Sequential_Receive_IT(I2C_HandleTypeDef *hi2c, uint8_t *data, uint16_t size, uint32_t options);
+HAL_StatusTypeDef HAL_I2C_Slave_Seq_Transmit_IT(I2C_HandleTypeDef *hi2c, uint8_t *data, uint16_t size, uint32_t options);
+
+/** HAL callback, implemented by driver */
+void HAL_I2C_AddrCallback(I2C_HandleTypeDef *hi2c, uint8_t TransferDirection, uint16_t AddrMatchCode);
+void HAL_I2C_ListenCpltCallback(I2C_HandleTypeDef *hi2c);
+void HAL_I2C_SlaveRxCpltCallback(I2C_HandleTypeDef *hi2c);
+void HAL_I2C_SlaveTxCpltCallback(I2C_HandleTypeDef *hi2c);
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c);
+
+/** LL USART, SR flag set by test, byte received / sent on DR
+ * handle taken as void *, driver keep it as uint32_t * (see. FS.uart_handler)
+ */
+typedef struct
+{
+    volatile uint32_t SR;
+    volatile uint32_t DR;
+    volatile uint32_t CR1;
+} USART_TypeDef;
+
+extern USART_TypeDef stub_usart1;
+#define USART1                      (&stub_usart1)
+#define USART_SR_PE                 (1U << 0)
+#define USART_SR_FE                 (1U << 1)
+#define USART_SR_NE                 (1U << 2)
+#define USART_SR_ORE                (1U << 3)
+#define USART_SR_IDLE               (1U << 4)
+#define USART_SR_RXNE               (1U << 5)
+#define USART_SR_TC                 (1U << 6)
+#define USART_SR_TXE                (1U << 7)
+#define USART_CR1_TXEIE             (1U << 7)
+
+static inline uint32_t LL_USART_IsActiveFlag_FE(void *p) { USART_TypeDef *u = p; return !!(u->SR & USART_SR_FE); }
+static inline uint32_t LL_USART_IsActiveFlag_NE(void *p) { USART_TypeDef *u = p; return !!(u->SR & USART_SR_NE); }
+static inline uint32_t LL_USART_IsActiveFlag_ORE(void *p) { USART_TypeDef *u = p; return !!(u->SR & USART_SR_ORE); }
+static inline uint32_t LL_USART_IsActiveFlag_IDLE(void *p) { USART_TypeDef *u = p; return !!(u->SR & USART_SR_IDLE); }
+static inline uint32_t LL_USART_IsActiveFlag_RXNE(void *p) { USART_TypeDef *u = p; return !!(u->SR & USART_SR_RXNE); }
+static inline uint32_t LL_USART_IsActiveFlag_TC(void *p) { USART_TypeDef *u = p; return !!(u->SR & USART_SR_TC); }
+static inline uint32_t LL_USART_IsActiveFlag_TXE(void *p) { USART_TypeDef *u = p; return !!(u->SR & USART_SR_TXE); }
+static inline void LL_USART_ClearFlag_ORE(void *p) { USART_TypeDef *u = p; u->SR &= ~(USART_SR_ORE | USART_SR_FE | USART_SR_NE); }
+static inline void LL_USART_ClearFlag_IDLE(void *p) { USART_TypeDef *u = p; u->SR &= ~USART_SR_IDLE; }
+static inline void LL_USART_ClearFlag_TC(void *p) { USART_TypeDef *u = p; u->SR &= ~USART_SR_TC; }
+static inline uint8_t LL_USART_ReceiveData8(void *p) { USART_TypeDef *u = p; u->SR &= ~USART_SR_RXNE; return (uint8_t) u->DR; }
+static inline void LL_USART_TransmitData8(void *p, uint8_t v) { USART_TypeDef *u = p; u->DR = v; }
+static inline void LL_USART_EnableIT_TXE(void *p) { USART_TypeDef *u = p; u->CR1 |= USART_CR1_TXEIE; }
+static inline void LL_USART_DisableIT_TXE(void *p) { USART_TypeDef *u = p; u->CR1 &= ~USART_CR1_TXEIE; }
+static inline uint32_t LL_USART_IsEnabledIT_TXE(void *p) { USART_TypeDef *u = p; return !!(u->CR1 & USART_CR1_TXEIE); }
+static inline void LL_USART_EnableIT_RXNE(void *p) {}
+static inline void LL_USART_EnableIT_IDLE(void *p) {}
+static inline void LL_USART_EnableIT_ERROR(void *p) {}
+static inline void LL_USART_EnableDMAReq_RX(void *p) {}
+static inline uint32_t LL_USART_DMA_GetRegAddr(void *p) { return 0; }
+
+/** LL DMA, remaining length per channel set by test */
+typedef struct
+{
+    volatile uint32_t ISR;
+    volatile uint32_t CNDTR[8];
+} DMA_TypeDef;
+
+extern DMA_TypeDef stub_dma1;
+#define DMA1                                (&stub_dma1)
+#define LL_DMA_CHANNEL_5                    5U
+#define LL_DMA_DIRECTION_PERIPH_TO_MEMORY   0U
+#define LL_DMA_MODE_CIRCULAR                0U
+#define LL_DMA_PERIPH_NOINCREMENT           0U
+#define LL_DMA_MEMORY_INCREMENT             0U
+#define LL_DMA_PDATAALIGN_BYTE              0U
+#define LL_DMA_MDATAALIGN_BYTE              0U
+#define LL_DMA_PRIORITY_MEDIUM              0U
+#define LL_AHB1_GRP1_PERIPH_DMA1            0U
+#define DMA_ISR_HTIF5                       (1U << 18)
+#define DMA_ISR_TCIF5                       (1U << 17)
+
+static inline void LL_AHB1_GRP1_EnableClock(uint32_t p) {}
+static inline void LL_DMA_ConfigTransfer(DMA_TypeDef *d, uint32_t ch, uint32_t cfg) {}
+static inline void LL_DMA_ConfigAddresses(DMA_TypeDef *d, uint32_t ch, uint32_t src, uint32_t dst, uint32_t dir) {}
+static inline void LL_DMA_SetDataLength(DMA_TypeDef *d, uint32_t ch, uint32_t n) { d->CNDTR[ch] = n; }
+static inline uint32_t LL_DMA_GetDataLength(DMA_TypeDef *d, uint32_t ch) { return d->CNDTR[ch]; }
+static inline void LL_DMA_EnableIT_HT(DMA_TypeDef *d, uint32_t ch) {}
+static inline void LL_DMA_EnableIT_TC(DMA_TypeDef *d, uint32_t ch) {}
+static inline void LL_DMA_EnableChannel(DMA_TypeDef *d, uint32_t ch) {}
+static inline uint32_t LL_DMA_IsActiveFlag_HT5(DMA_TypeDef *d) { return !!(d->ISR & DMA_ISR_HTIF5); }
+static inline uint32_t LL_DMA_IsActiveFlag_TC5(DMA_TypeDef *d) { return !!(d->ISR & DMA_ISR_TCIF5); }
+static inline void LL_DMA_ClearFlag_HT5(DMA_TypeDef *d) { d->ISR &= ~DMA_ISR_HTIF5; }
+static inline void LL_DMA_ClearFlag_TC5(DMA_TypeDef *d) { d->ISR &= ~DMA_ISR_TCIF5; }
+
+/** CMSIS NVIC */
+static inline uint32_t NVIC_GetPriorityGrouping(void) { return 0; }
+static inline uint32_t NVIC_EncodePriority(uint32_t group, uint32_t pre, uint32_t sub) { return 0; }
+static inline void NVIC_SetPriority(IRQn_Type irq, uint32_t prio) {}
+static inline void NVIC_EnableIRQ(IRQn_Type irq) {}
+
+/** last transfer armed by slave, see. hal_stub.c */
+typedef struct
+{
+    uint8_t *rx_buf;
+    uint16_t rx_size;
+    uint8_t *tx_buf;
+    uint16_t tx_size;
+    uint32_t rx_arm;
+    uint32_t tx_arm;
+    uint32_t listen;
+} Stub_I2C_t;
+
+extern Stub_I2C_t stub_i2c;
+
+#endif /* MAIN_H */
@@ -0,0 +1,254 @@
+/**
+ * @file test_fs_sim.c
+ * @brief   Venice X simulator on host, whole application (scheduler,
+ *          communication_fs_handler(), run_application(), key command
+ *          scheduler, parser, adaptive polling) against fs_sim scenario
+ *          without FS4340 module and without simulator on firmware image
+ *
+ *          built with CONFIG_FS_SIMULATOR=1, one binary per scenario
+ *          (see. test/Makefile)
+ *          test_fs_sim:                FS_SIM_SCENARIO_BOOT, then key command
+ *          test_fs_sim_wifi_setup:     FS_SIM_SCENARIO_WIFI_SETUP
+ *          test_fs_sim_mode_switch:    FS_SIM_SCENARIO_MODE_SWITCH
+ *          test_fs_sim_late_boot:      FS_SIM_SCENARIO_LATE_BOOT
+ *
+ *          test run in order, each continue from previous module state
+ */
+#include <string.h>
+#include "main.h"
+#include "test_util.h"
+#include "apps/main_task.h"
+#include "drivers/uart/fs_comm.h"
+#include "drivers/uart/fs_sim.h"
+
+int test_failed;
+
+static uint32_t first_reply_tick;
+
+/** key command sent to status change, module reply after
+ * FS_SIM_REPLY_DELAY, key sent on next communication task run
+ */
+#define KEY_LATENCY_BOUND       (FS_SIM_REPLY_DELAY + 2 * SCH_PERIOD_COMM)
+/** change on module seen on next status request, slowest interval */
+#define CHANGE_LATENCY_BOUND    (FS_SYSTEM_REQ_TIME + FS_SIM_REPLY_DELAY + 2 * SCH_PERIOD_COMM)
+
+/** main loop (see. main.c) for ms, idle sleep advance tick (see. __WFI stub) */
+static void run_ms(uint32_t ms)
+{
+    uint32_t end = uwTick + ms;
+
+    while ((int32_t)(uwTick - end) < 0)
+    {
+        main_task_run(NULL);
+
+        if (!first_reply_tick && fs_sim.reply_count)
+            first_reply_tick = uwTick;
+    }
+}
+
+static void setup(void)
+{
+    uwTick = 1;
+    main_task_init();
+    /** stub SysTick not counting, 1 ms tick kept on idle */
+    low_power_set_tickless(0);
+}
+
+#if (CONFIG_FS_SIM_SCENARIO == FS_SIM_SCENARIO_BOOT)
+
+static void test_boot(void)
+{
+    uint8_t volume;
+
+    setup();
+    run_ms(1000);
+    volume = system_config.system_volume;
+
+    /** key on booting, venice x not ready, dropped */
+    event_queue_post_u8(&app_event_queue, EVQ_PRIO_NORMAL, MSG_VOL_UP, EVENT_SRC_I2C, 0);
+    run_ms(8000);
+    CHECK_EQ(system_config.system_volume, volume);
+    /** scripted volume, no key reached module */
+    CHECK_EQ(FS.config.data2.bit.volume, 15);
+
+    /** module silent first 3 s */
+    CHECK(first_reply_tick >= 3000);
+    CHECK_EQ(FS.poll.replied, 1);
+    CHECK_EQ(FS.config.data0.bit.wifi_status, FS_WIFI_STATE_CONNECTED);
+    CHECK_EQ(FS.config.data1.bit.mode, FS_MODE_SPOTIFY);
+    CHECK_EQ(FS.config.data1.bit.spotify_status, FS_SPOTIFY_ACCOUNT_LOGIN);
+    CHECK_EQ(system_config.venicex_state, VENICEX_STATE_READY);
+    CHECK_EQ(read_reg->wifi_status, FS_WIFI_STATE_CONNECTED);
+    CHECK_EQ(FS.rx_crc_error, 0);
+    CHECK_EQ(FS.rx_discard, 0);
+}
+
+static void test_idle_back_off(void)
+{
+    run_ms(10000);
+
+    /** status stable, polling back to slowest interval */
+    CHECK_EQ(FS.poll.interval, FS_SYSTEM_REQ_TIME);
+}
+
+static void test_volume_merged(void)
+{
+    uint32_t key = fs_sim.key_count;
+    uint8_t volume = FS.config.data2.bit.volume;
+
+    fs_comm_send_command(KC_VOLUME_UP, 0);
+    fs_comm_send_command(KC_VOLUME_UP, 0);
+    fs_comm_send_command(KC_VOLUME_UP, 0);
+    run_ms(200);
+
+    CHECK_EQ(FS.config.data2.bit.volume, volume + 3);
+    /** one KC_SET_VOLUME, rest is status request */
+    CHECK(FS.sched.merged >= 2);
+    CHECK(fs_sim.key_count > key);
+}
+
+static void test_standby_in_order(void)
+{
+    uint32_t key, merged;
+
+    run_ms(2000);
+    key = fs_sim.key_count;
+    merged = FS.sched.merged;
+
+    fs_comm_send_command(KC_STANDBY, 0);
+    fs_comm_send_command(KC_BLUETOOTH_MODE, 0);
+    fs_comm_send_command(KC_STANDBY, 0);
+
+    /** standby is toggle, never merged with mode command */
+    CHECK_EQ(FS.sched.merged, merged);
+    run_ms(200);
+
+    /** every press reach module, last one applied */
+    CHECK(fs_sim.key_count - key >= 3);
+    CHECK_EQ(FS.config.data1.bit.mode, FS_MODE_STANDBY);
+
+}
+
+/** mode then key sent as given, play / pause only toggle on spotify mode */
+static void test_mode_then_key(void)
+{
+    fs_comm_send_command(KC_BLUETOOTH_MODE, 0);
+    run_ms(200);
+    CHECK_EQ(FS.config.data1.bit.mode, FS_MODE_BLUETOOTH);
+
+    fs_comm_send_command(KC_SPOTIFY_MODE, 0);
+    fs_comm_send_command(KC_PLAY_PAUSE, 0);
+    run_ms(200);
+
+    CHECK_EQ(FS.config.data1.bit.mode, FS_MODE_SPOTIFY);
+    CHECK_EQ(FS.config.data1.bit.spotify_status, FS_SPOTIFY_PLAYING);
+}
+
+static void test_factory_reset(void)
+{
+    fs_comm_send_command(KC_FACTORY_RESET, 0);
+    run_ms(13000);
+
+    /** rebooted to setup mode, fast polling kept while on setup */
+    CHECK_EQ(FS.config.data0.bit.wifi_status, FS_WIFI_SETUP_MODE);
+    CHECK_EQ(FS.poll.interval, FS_SYSTEM_REQ_FAST_TIME);
+}
+
+#elif (CONFIG_FS_SIM_SCENARIO == FS_SIM_SCENARIO_WIFI_SETUP)
+
+static void test_wifi_setup(void)
+{
+    setup();
+    run_ms(6000);
+
+    /** no network, module on setup mode, fast polling kept */
+    CHECK_EQ(FS.config.data0.bit.wifi_status, FS_WIFI_SETUP_MODE);
+    CHECK_EQ(read_reg->wifi_status, FS_WIFI_SETUP_MODE);
+    CHECK_EQ(system_config.current_function, SYS_MODE_NETWORK_CONFIG);
+    CHECK_EQ(FS.poll.interval, FS_SYSTEM_REQ_FAST_TIME);
+
+    fs_comm_send_command(KC_VOLUME_UP, 0);
+    run_ms(34000);
+
+    /** network configured by user, spotify login */
+    CHECK_EQ(FS.config.data0.bit.wifi_status, FS_WIFI_STATE_CONNECTED);
+    CHECK_EQ(FS.config.data1.bit.mode, FS_MODE_SPOTIFY);
+    CHECK_EQ(FS.config.data1.bit.spotify_status, FS_SPOTIFY_ACCOUNT_LOGIN);
+    CHECK_EQ(read_reg->wifi_status, FS_WIFI_STATE_CONNECTED);
+    CHECK_EQ(system_config.current_function, SYS_MODE_SPOTIFY_CONNECT);
+    CHECK_EQ(FS.rx_crc_error, 0);
+
+    CHECK(FS.poll.key_latency_max > 0);
+    CHECK(FS.poll.key_latency_max <= KEY_LATENCY_BOUND);
+    CHECK(FS.poll.change_latency_max <= CHANGE_LATENCY_BOUND);
+}
+
+#elif (CONFIG_FS_SIM_SCENARIO == FS_SIM_SCENARIO_MODE_SWITCH)
+
+static void test_mode_switch(void)
+{
+    setup();
+    run_ms(6000);
+
+    /** spotify to bluetooth pushed by module */
+    CHECK_EQ(FS.config.data1.bit.mode, FS_MODE_BLUETOOTH);
+    CHECK_EQ(FS.config.data0.bit.bt_status, FS_BT_DISCOVERABLE);
+    CHECK_EQ(read_reg->mode, FS_MODE_BLUETOOTH);
+    CHECK_EQ(system_config.current_function, SYS_MODE_BT_A2DP);
+
+    fs_comm_send_command(KC_VOLUME_DOWN, 0);
+    run_ms(6000);
+
+    /** bluetooth connect seen on polling only, then back to spotify */
+    CHECK_EQ(FS.config.data1.bit.mode, FS_MODE_SPOTIFY);
+    CHECK_EQ(system_config.current_function, SYS_MODE_SPOTIFY_CONNECT);
+
+    run_ms(3000);
+
+    /** standby and mute, seen on polling only */
+    CHECK_EQ(FS.config.data1.bit.mode, FS_MODE_STANDBY);
+    CHECK_EQ(FS.config.data2.bit.mute, 1);
+    CHECK_EQ(read_reg->mode, FS_MODE_STANDBY);
+    CHECK_EQ(FS.rx_crc_error, 0);
+
+    CHECK(FS.poll.key_latency_max > 0);
+    CHECK(FS.poll.key_latency_max <= KEY_LATENCY_BOUND);
+    CHECK(FS.poll.change_latency_max <= CHANGE_LATENCY_BOUND);
+}
+
+#elif (CONFIG_FS_SIM_SCENARIO == FS_SIM_SCENARIO_LATE_BOOT)
+
+static void test_late_boot(void)
+{
+    setup();
+    run_ms(7000);
+
+    CHECK(first_reply_tick >= 2870);
+    CHECK_EQ(FS.config.data0.byte, 0x01);
+    CHECK_EQ(FS.config.data1.byte, 0x12);
+    CHECK_EQ(FS.config.data2.byte, 0x0F);
+    CHECK_EQ(FS.config.data3.byte, 0x00);
+    CHECK_EQ(FS.rx_crc_error, 0);
+}
+
+#endif
+
+int main(void)
+{
+#if (CONFIG_FS_SIM_SCENARIO == FS_SIM_SCENARIO_BOOT)
+    RUN_TEST(test_boot);
+    RUN_TEST(test_idle_back_off);
+    RUN_TEST(test_volume_merged);
+    RUN_TEST(test_standby_in_order);
+    RUN_TEST(test_mode_then_key);
+    RUN_TEST(test_factory_reset);
+#elif (CONFIG_FS_SIM_SCENARIO == FS_SIM_SCENARIO_WIFI_SETUP)
+    RUN_TEST(test_wifi_setup);
+#elif (CONFIG_FS_SIM_SCENARIO == FS_SIM_SCENARIO_MODE_SWITCH)
+    RUN_TEST(test_mode_switch);
+#elif (CONFIG_FS_SIM_SCENARIO == FS_SIM_SCENARIO_LATE_BOOT)
+    RUN_TEST(test_late_boot);
+#endif
+
+    return TEST_RESULT();
+}
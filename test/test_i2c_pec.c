@@ -0,0 +1,165 @@
+/**
+ * @file test_i2c_pec.c
+ * @brief   i2c_comm.c register access with PEC (CONFIG_I2C_PEC_ENABLE)
+ *          scripted master on HAL I2C callback, see. test_i2c_slave.c
+ *          read:  data from start register till end of read group, then
+ *                 PEC over [addr+W] [reg] [addr+R] [data ...]
+ *          write: [reg] [data ...] [PEC], rejected on PEC mismatch
+ */
+#include <string.h>
+#include "test_util.h"
+#include "i2c_comm.h"
+#include "sys_app.h"
+#include "utility/crc.h"
+
+int test_failed;
+
+#define SLAVE_ADDR  0x48
+
+/** working register map, see. i2c_comm.c */
+extern uint8_t I2C_Registers[I2C_REGISTER_MAP_LEN];
+
+/** see. sys_app.c, not built on this test */
+EVQ_Context_t app_event_queue;
+
+static I2C_HandleTypeDef hi2c;
+
+static void master_stop(void)
+{
+    hi2c.ErrorCode = HAL_I2C_ERROR_AF;
+    HAL_I2C_ErrorCallback(&hi2c);
+    hi2c.ErrorCode = 0;
+}
+
+static void master_write(const uint8_t *bytes, uint8_t n)
+{
+    HAL_I2C_AddrCallback(&hi2c, I2C_DIRECTION_TRANSMIT, SLAVE_ADDR << 1);
+    memcpy(stub_i2c.rx_buf, bytes, n);
+    hi2c.hdmarx->counter = stub_i2c.rx_size - n;
+    master_stop();
+}
+
+/** [reg] then repeated start, master read n byte, NACK + STOP
+ * @return  number of byte armed by slave
+ */
+static uint16_t master_read(uint8_t reg, uint8_t *out, uint8_t n)
+{
+    uint16_t armed;
+
+    HAL_I2C_AddrCallback(&hi2c, I2C_DIRECTION_TRANSMIT, SLAVE_ADDR << 1);
+    stub_i2c.rx_buf[0] = reg;
+    hi2c.hdmarx->counter = stub_i2c.rx_size - 1;
+
+    HAL_I2C_AddrCallback(&hi2c, I2C_DIRECTION_RECEIVE, SLAVE_ADDR << 1);
+    armed = stub_i2c.tx_size;
+    memcpy(out, stub_i2c.tx_buf, n);
+    hi2c.hdmatx->counter = stub_i2c.tx_size - n;
+    master_stop();
+    return armed;
+}
+
+static uint8_t read_pec(uint8_t reg, const uint8_t *data, uint8_t n)
+{
+    uint8_t crc;
+
+    crc = crc8_update(0, SLAVE_ADDR << 1);
+    crc = crc8_update(crc, reg);
+    crc = crc8_update(crc, (SLAVE_ADDR << 1) | 0x01);
+    return crc8(crc, data, n);
+}
+
+static void setup(void)
+{
+    uint8_t i;
+
+    memset(&hi2c, 0, sizeof(hi2c));
+    memset(&i2c_slave, 0, sizeof(i2c_slave));
+    i2c_slave_msp_init(&hi2c);
+    i2c_comm_init();
+
+    for (i = 0; i < REG_GENERATION; i++)
+        I2C_Registers[i] = 0xA0 + i;
+    i2c_comm_handler();
+}
+
+/** read from REG_FIRMWARE_ID cover whole status block, not only width of
+ * REG_SYSTEM_REQ write descriptor
+ */
+static void test_read_status_block(void)
+{
+    uint8_t out[REG_DIAG_BASE + 1];
+
+    setup();
+    CHECK_EQ(master_read(REG_FIRMWARE_ID, out, sizeof(out)), REG_DIAG_BASE + 1);
+    CHECK(memcmp(out, &I2C_Registers[REG_FIRMWARE_ID], REG_DIAG_BASE) == 0);
+    CHECK_EQ(out[REG_DIAG_BASE], read_pec(REG_FIRMWARE_ID, out, REG_DIAG_BASE));
+}
+
+/** start inside group, data till group end */
+static void test_read_mid_group(void)
+{
+    uint8_t out[REG_DIAG_BASE - REG_MODE + 1];
+
+    setup();
+    CHECK_EQ(master_read(REG_MODE, out, sizeof(out)), sizeof(out));
+    CHECK(memcmp(out, &I2C_Registers[REG_MODE], sizeof(out) - 1) == 0);
+    CHECK_EQ(out[sizeof(out) - 1], read_pec(REG_MODE, out, sizeof(out) - 1));
+}
+
+static void test_read_diag_group(void)
+{
+    uint8_t out[REG_FS_DIAG_LEN + 1];
+
+    setup();
+    CHECK_EQ(master_read(REG_FS_DIAG_BASE, out, sizeof(out)), sizeof(out));
+    CHECK(memcmp(out, &I2C_Registers[REG_FS_DIAG_BASE], REG_FS_DIAG_LEN) == 0);
+    CHECK_EQ(out[REG_FS_DIAG_LEN], read_pec(REG_FS_DIAG_BASE, out, REG_FS_DIAG_LEN));
+
+    /** largest group, LED frame and commit */
+    {
+        uint8_t frame[REG_LED_FRAME_LEN + 2];
+
+        CHECK_EQ(master_read(REG_LED_FRAME_BASE, frame, sizeof(frame)), sizeof(frame));
+        CHECK_EQ(frame[REG_LED_FRAME_LEN + 1], read_pec(REG_LED_FRAME_BASE, frame, REG_LED_FRAME_LEN + 1));
+    }
+}
+
+/** register outside any group (gap before power diagnostic) */
+static void test_read_no_group(void)
+{
+    uint8_t out[2];
+
+    setup();
+    CHECK_EQ(master_read(REG_CHANGE_FLAGS + 1, out, sizeof(out)), 2);
+    CHECK_EQ(out[1], read_pec(REG_CHANGE_FLAGS + 1, out, 1));
+}
+
+static void test_write_pec(void)
+{
+    uint8_t seq[3] = { REG_AUXILIARY2, 0x5A, 0 };
+    uint8_t crc;
+
+    setup();
+    crc = crc8_update(0, SLAVE_ADDR << 1);
+    seq[2] = crc8(crc, seq, 2);
+    master_write(seq, sizeof(seq));
+    CHECK_EQ(I2C_Registers[REG_AUXILIARY2], 0x5A);
+
+    /** bad PEC, register unchanged and counted */
+    seq[1] = 0x33;
+    master_write(seq, sizeof(seq));
+    CHECK_EQ(I2C_Registers[REG_AUXILIARY2], 0x5A);
+    i2c_comm_handler();
+    CHECK_EQ(diag_reg->pec_error_count, 1);
+}
+
+int main(void)
+{
+    RUN_TEST(test_read_status_block);
+    RUN_TEST(test_read_mid_group);
+    RUN_TEST(test_read_diag_group);
+    RUN_TEST(test_read_no_group);
+    RUN_TEST(test_write_pec);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,236 @@
+/**
+ * @file test_i2c_slave.c
+ * @brief   i2c_slave.c driven by scripted master on HAL I2C callback
+ *          master write: ADDR (transmit) -> byte on DMA buffer -> STOP (AF)
+ *          master read:  ADDR (receive) -> byte taken from DMA buffer -> NACK + STOP (AF)
+ */
+#include <string.h>
+#include "test_util.h"
+#include "drivers/i2c/i2c_slave.h"
+
+int test_failed;
+
+#define REG_LEN     0x80
+#define SLAVE_ADDR  0x48
+
+static I2C_HandleTypeDef hi2c;
+static uint8_t reg_map[REG_LEN];
+
+/** upper layer record */
+static int write_calls;
+static uint8_t write_reg;
+static uint8_t write_len;
+static uint8_t write_data[RX_SIZE];
+static int read_begin_calls;
+static uint8_t read_begin_reg;
+static uint8_t read_end_count;
+
+static void process(I2C_Data_t *p)
+{
+    write_calls++;
+    write_reg = p->reg;
+    write_len = p->len;
+    memcpy(write_data, p->data, p->len);
+}
+
+static uint8_t *read_begin(uint8_t reg, uint8_t *len)
+{
+    read_begin_calls++;
+    read_begin_reg = reg;
+    *len = REG_LEN - reg;
+    return &reg_map[reg];
+}
+
+static void read_end(uint8_t reg, uint8_t count)
+{
+    read_end_count = count;
+}
+
+static const I2C_ReadCallback_t read_cb = { read_begin, read_end };
+
+/** master send bytes after ADDR (transmit), DMA complete when buffer full */
+static void master_write_bytes(const uint8_t *bytes, uint8_t n)
+{
+    uint8_t len;
+
+    HAL_I2C_AddrCallback(&hi2c, I2C_DIRECTION_TRANSMIT, SLAVE_ADDR << 1);
+    len = (n > stub_i2c.rx_size) ? stub_i2c.rx_size : n;
+    memcpy(stub_i2c.rx_buf, bytes, len);
+    hi2c.hdmarx->counter = stub_i2c.rx_size - len;
+    if (len == stub_i2c.rx_size)
+    {
+        HAL_I2C_SlaveRxCpltCallback(&hi2c);
+    }
+}
+
+static void master_stop(void)
+{
+    hi2c.ErrorCode = HAL_I2C_ERROR_AF;
+    HAL_I2C_ErrorCallback(&hi2c);
+    hi2c.ErrorCode = 0;
+}
+
+static void master_write(const uint8_t *bytes, uint8_t n)
+{
+    master_write_bytes(bytes, n);
+    master_stop();
+}
+
+/** master read n byte (repeated start or new transaction), NACK + STOP */
+static void master_read(uint8_t *out, uint8_t n)
+{
+    HAL_I2C_AddrCallback(&hi2c, I2C_DIRECTION_RECEIVE, SLAVE_ADDR << 1);
+    memcpy(out, stub_i2c.tx_buf, n);
+    hi2c.hdmatx->counter = stub_i2c.tx_size - n;
+    master_stop();
+}
+
+static void setup(void)
+{
+    uint16_t i;
+
+    memset(&hi2c, 0, sizeof(hi2c));
+    memset(&i2c_slave, 0, sizeof(i2c_slave));
+    i2c_slave_msp_init(&hi2c);
+    i2c_slave_init(process, &read_cb, REG_LEN);
+
+    for (i = 0; i < REG_LEN; i++)
+        reg_map[i] = (uint8_t) i;
+
+    write_calls = 0;
+    read_begin_calls = 0;
+}
+
+static void test_single_register_write(void)
+{
+    const uint8_t seq[] = { 0x03, 0x15 };
+
+    setup();
+    master_write(seq, sizeof(seq));
+
+    CHECK_EQ(write_calls, 1);
+    CHECK_EQ(write_reg, 0x03);
+    CHECK_EQ(write_len, 1);
+    CHECK_EQ(write_data[0], 0x15);
+}
+
+static void test_burst_write_one_callback(void)
+{
+    /** R G B on one transaction, auto increment from REG_LED_RED */
+    const uint8_t seq[] = { 0x0C, 0x11, 0x22, 0x33 };
+
+    setup();
+    master_write(seq, sizeof(seq));
+
+    CHECK_EQ(write_calls, 1);
+    CHECK_EQ(write_reg, 0x0C);
+    CHECK_EQ(write_len, 3);
+    CHECK(memcmp(write_data, &seq[1], 3) == 0);
+}
+
+static void test_register_only_then_read(void)
+{
+    const uint8_t seq[] = { 0x05 };
+    uint8_t out[3];
+
+    setup();
+    master_write_bytes(seq, sizeof(seq));
+    master_read(out, sizeof(out));
+
+    /** register pointer only, no write callback */
+    CHECK_EQ(write_calls, 0);
+    CHECK_EQ(read_begin_calls, 1);
+    CHECK_EQ(read_begin_reg, 0x05);
+    CHECK_EQ(out[0], 0x05);
+    CHECK_EQ(out[2], 0x07);
+}
+
+static void test_burst_fill_buffer(void)
+{
+    uint8_t seq[RX_SIZE];
+    uint8_t i;
+
+    setup();
+    seq[0] = 0x40;
+    for (i = 1; i < RX_SIZE; i++)
+        seq[i] = i;
+
+    master_write(seq, sizeof(seq));
+
+    /** dispatched on buffer full, not again on STOP */
+    CHECK_EQ(write_calls, 1);
+    CHECK_EQ(write_reg, 0x40);
+    CHECK_EQ(write_len, RX_SIZE - 1);
+    CHECK_EQ(write_data[RX_SIZE - 2], RX_SIZE - 1);
+}
+
+static void test_burst_fill_buffer_then_read(void)
+{
+    uint8_t seq[RX_SIZE];
+    uint8_t out[2];
+
+    setup();
+    memset(seq, 0x5A, sizeof(seq));
+    seq[0] = 0x40;
+
+    master_write_bytes(seq, sizeof(seq));
+    master_read(out, sizeof(out));
+
+    /** repeated start after full burst, write not applied twice */
+    CHECK_EQ(write_calls, 1);
+    CHECK_EQ(read_begin_calls, 1);
+}
+
+static void test_read_last_register(void)
+{
+    const uint8_t seq[] = { REG_LEN - 1 };
+    uint8_t out[1];
+
+    setup();
+    master_write_bytes(seq, sizeof(seq));
+    master_read(out, sizeof(out));
+
+    CHECK_EQ(read_begin_reg, REG_LEN - 1);
+    CHECK_EQ(out[0], REG_LEN - 1);
+}
+
+static void test_read_outside_register_map(void)
+{
+    const uint8_t seq[] = { REG_LEN };
+    uint8_t out[1];
+
+    setup();
+    master_write_bytes(seq, sizeof(seq));
+    master_read(out, sizeof(out));
+
+    CHECK_EQ(read_begin_reg, 0);
+}
+
+static void test_back_to_back_bursts(void)
+{
+    const uint8_t a[] = { 0x0C, 1, 2, 3 };
+    const uint8_t b[] = { 0x0A, 9 };
+
+    setup();
+    master_write(a, sizeof(a));
+    master_write(b, sizeof(b));
+
+    CHECK_EQ(write_calls, 2);
+    CHECK_EQ(write_reg, 0x0A);
+    CHECK_EQ(write_len, 1);
+    CHECK_EQ(write_data[0], 9);
+}
+
+int main(void)
+{
+    RUN_TEST(test_single_register_write);
+    RUN_TEST(test_burst_write_one_callback);
+    RUN_TEST(test_register_only_then_read);
+    RUN_TEST(test_burst_fill_buffer);
+    RUN_TEST(test_burst_fill_buffer_then_read);
+    RUN_TEST(test_read_last_register);
+    RUN_TEST(test_read_outside_register_map);
+    RUN_TEST(test_back_to_back_bursts);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,168 @@
+/**
+ * @file test_i2c_timing.c
+ * @brief   i2c slave interrupt accounting and timing model
+ *          ISR duration trace replayed on i2c_slave_irq_enter / irq_exit
+ *          (cycle counter driven by test), overrun and worst case checked
+ *          against driver accounting
+ *          stretch budget and status read throughput only reported, model
+ *          of estimated duration, not a measurement (no pass / fail)
+ *
+ *          test/build/test_i2c_timing [trace]
+ *          trace: one interrupt per line "<name> <cycles> <stretch>"
+ *                 cycles: core cycle (72 MHz), e.g. from DWT on target
+ *                 stretch: 1 when SCL held low while interrupt served
+ *          without trace, estimated trace below is used
+ */
+#include <stdio.h>
+#include <string.h>
+#include "test_util.h"
+#include "drivers/i2c/i2c_slave.h"
+
+int test_failed;
+
+#define CORE_CLOCK_MHZ      72
+#define STATUS_READ_LEN     16      /** REG_BOOT_INFO .. REG_GENERATION */
+#define TRACE_MAX           64
+
+typedef struct
+{
+    char name[16];
+    uint32_t cycles;
+    uint8_t stretch;
+} IsrEvent_t;
+
+/** estimated trace, one status read on DMA path
+ * [W reg] [Sr R data x16 NACK] [P]
+ * estimated from handler path at -O2, not measured on target
+ */
+static IsrEvent_t trace[TRACE_MAX] =
+{
+    { "addr_write",     420,    1 },    // ADDR, arm rx DMA
+    { "addr_read",      610,    1 },    // ADDR on repeated start, register pointer + arm tx DMA
+    { "nack",           280,    0 },    // AF after last byte, read end
+    { "stop",           350,    0 },    // STOPF, listen re-armed
+};
+static int trace_len = 4;
+
+static I2C_HandleTypeDef hi2c;
+
+static void process(I2C_Data_t *p)
+{
+}
+
+static int trace_load(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    IsrEvent_t ev;
+    unsigned cycles, stretch;
+    int n = 0;
+
+    if (!f) return -1;
+
+    while (n < TRACE_MAX && fscanf(f, "%15s %u %u", ev.name, &cycles, &stretch) == 3)
+    {
+        ev.cycles = cycles;
+        ev.stretch = (uint8_t) stretch;
+        trace[n++] = ev;
+    }
+
+    fclose(f);
+    trace_len = n;
+    return n;
+}
+
+/** stretch budget (core cycle) at bus clock, see. I2C_SLAVE_STRETCH_BUDGET_US */
+static uint32_t budget_cycles(uint32_t clock)
+{
+    return (4 * 1000000 / clock) * CORE_CLOCK_MHZ;
+}
+
+/** one status read on the bus (us): byte time + SCL held by interrupt */
+static double status_read_us(uint32_t clock)
+{
+    /** addr W, register, addr R, data; 9 bit each + start, restart, stop */
+    double bits = 9.0 * (3 + STATUS_READ_LEN) + 3;
+    double us = bits * 1000000.0 / clock;
+    int i;
+
+    for (i = 0; i < trace_len; i++)
+    {
+        if (trace[i].stretch)
+            us += (double) trace[i].cycles / CORE_CLOCK_MHZ;
+    }
+
+    return us;
+}
+
+static void setup(void)
+{
+    memset(&hi2c, 0, sizeof(hi2c));
+    memset(&i2c_slave, 0, sizeof(i2c_slave));
+    SystemCoreClock = CORE_CLOCK_MHZ * 1000000;
+    i2c_slave_msp_init(&hi2c);
+    i2c_slave_init(process, NULL, 0x80);
+}
+
+/** replay trace on driver accounting, overrun count same as trace */
+static void test_overrun_accounting(void)
+{
+    uint32_t overrun = 0, worst = 0;
+    int i;
+
+    setup();
+    CHECK_EQ(i2c_slave.stretch_budget, budget_cycles(I2C_SLAVE_CLOCK_SPEED));
+
+    stub_dwt.CYCCNT = 0xFFFFFF00;   // wrap inside trace
+    for (i = 0; i < trace_len; i++)
+    {
+        i2c_slave_irq_enter();
+        stub_dwt.CYCCNT += trace[i].cycles;
+        i2c_slave_irq_exit();
+        stub_dwt.CYCCNT += 1000;
+
+        if (trace[i].cycles > i2c_slave.stretch_budget) overrun++;
+        if (trace[i].cycles > worst) worst = trace[i].cycles;
+    }
+
+    CHECK_EQ(i2c_slave.stretch_overrun, overrun);
+    CHECK_EQ(i2c_slave.isr_cycles_max, worst);
+}
+
+/** model report: trace against fast mode budget (10 us) */
+static void report_fast_mode_budget(void)
+{
+    uint32_t budget = budget_cycles(400000);
+    int i;
+
+    for (i = 0; i < trace_len; i++)
+    {
+        printf("  %-12s %5u cycle %6.2f us %s\n", trace[i].name, (unsigned) trace[i].cycles,
+               (double) trace[i].cycles / CORE_CLOCK_MHZ,
+               (trace[i].stretch && trace[i].cycles > budget) ? "OVER 400 kHz BUDGET" : "");
+    }
+}
+
+/** model report: status read time, bus clock plus stretch of trace */
+static void report_status_read_throughput(void)
+{
+    double t100 = status_read_us(100000);
+    double t400 = status_read_us(400000);
+
+    printf("  status read %d byte: 100 kHz %.1f us (%.0f/s), 400 kHz %.1f us (%.0f/s)\n",
+           STATUS_READ_LEN, t100, 1000000.0 / t100, t400, 1000000.0 / t400);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1 && trace_load(argv[1]) <= 0)
+    {
+        printf("cannot read trace %s\n", argv[1]);
+        return 1;
+    }
+
+    RUN_TEST(test_overrun_accounting);
+    RUN_TEST(report_fast_mode_budget);
+    RUN_TEST(report_status_read_throughput);
+
+    return TEST_RESULT();
+}
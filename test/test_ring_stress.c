@@ -0,0 +1,190 @@
+/**
+ * @file test_ring_stress.c
+ * @brief   MCU_CIRCULAR_CONTEXT single producer / single consumer on two
+ *          thread (producer as uart interrupt, consumer as main loop)
+ *          byte stream checked in order, no loss, no duplicate
+ *          small ring so index wrap and full / empty race happen often
+ *          thread yield on full / empty ring, so test also run on one core
+ */
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include "test_util.h"
+#include "utility/circular_buffer.h"
+
+int test_failed;
+
+#define RING_LEN        64
+#define STREAM_TOTAL    (8UL << 20)
+
+static uint8_t ring_mem[RING_LEN];
+static MCU_CIRCULAR_CONTEXT ring;
+
+static volatile uint32_t mismatch;
+static uint32_t consumed;
+
+/** expected byte at stream position */
+static inline uint8_t stream_byte(uint32_t pos)
+{
+    return (uint8_t)(pos * 131 + (pos >> 9));
+}
+
+static inline uint32_t xorshift(uint32_t *s)
+{
+    *s ^= *s << 13;
+    *s ^= *s >> 17;
+    *s ^= *s << 5;
+    return *s;
+}
+
+static void *producer_put(void *arg)
+{
+    uint8_t chunk[97];
+    uint32_t pos = 0, seed = 1, n, i;
+
+    while (pos < STREAM_TOTAL)
+    {
+        n = 1 + xorshift(&seed) % sizeof(chunk);
+        if (n > STREAM_TOTAL - pos) n = STREAM_TOTAL - pos;
+        for (i = 0; i < n; i++)
+            chunk[i] = stream_byte(pos + i);
+
+        /** full ring write less, rest sent on next round */
+        n = MCUCircular_PutData(&ring, chunk, n);
+        if (n == 0) sched_yield();
+        pos += n;
+    }
+    return NULL;
+}
+
+static void *consumer_get(void *arg)
+{
+    uint8_t chunk[83];
+    uint32_t seed = 7, n, i;
+
+    while (consumed < STREAM_TOTAL)
+    {
+        n = MCUCircular_GetData(&ring, chunk, 1 + xorshift(&seed) % sizeof(chunk));
+        if (n == 0) sched_yield();
+        for (i = 0; i < n; i++)
+        {
+            if (chunk[i] != stream_byte(consumed + i))
+                mismatch++;
+        }
+        consumed += n;
+    }
+    return NULL;
+}
+
+/** in place producer, as DMA / RXNE on reserved span */
+static void *producer_reserve(void *arg)
+{
+    MCU_CIRCULAR_SPAN span;
+    uint32_t pos = 0, seed = 3, n, i;
+
+    while (pos < STREAM_TOTAL)
+    {
+        if (MCUCircular_Reserve(&ring, &span) == 0)
+        {
+            sched_yield();
+            continue;
+        }
+
+        n = 1 + xorshift(&seed) % 40;
+        if (n > span.Len[0]) n = span.Len[0];
+        if (n > STREAM_TOTAL - pos) n = STREAM_TOTAL - pos;
+        for (i = 0; i < n; i++)
+            span.Ptr[0][i] = stream_byte(pos + i);
+
+        pos += MCUCircular_Commit(&ring, n);
+    }
+    return NULL;
+}
+
+/** in place consumer, as fs_comm_scan_data() */
+static void *consumer_peek(void *arg)
+{
+    MCU_CIRCULAR_SPAN span;
+    uint32_t seed = 11, n, m, i;
+
+    while (consumed < STREAM_TOTAL)
+    {
+        n = MCUCircular_Peek(&ring, &span);
+        if (n == 0)
+        {
+            sched_yield();
+            continue;
+        }
+
+        m = 1 + xorshift(&seed) % 50;
+        if (n > m) n = m;
+        for (i = 0; i < n; i++)
+        {
+            uint8_t b = (i < span.Len[0]) ? span.Ptr[0][i] : span.Ptr[1][i - span.Len[0]];
+            if (b != stream_byte(consumed + i))
+                mismatch++;
+        }
+        consumed += MCUCircular_Consume(&ring, n);
+    }
+    return NULL;
+}
+
+static void run(void *(*producer)(void *), void *(*consumer)(void *))
+{
+    pthread_t p, c;
+
+    MCUCircular_Config(&ring, ring_mem, RING_LEN);
+    mismatch = 0;
+    consumed = 0;
+
+    pthread_create(&c, NULL, consumer, NULL);
+    pthread_create(&p, NULL, producer, NULL);
+    pthread_join(p, NULL);
+    pthread_join(c, NULL);
+
+    CHECK_EQ(mismatch, 0);
+    CHECK_EQ(consumed, STREAM_TOTAL);
+    CHECK_EQ(MCUCircular_GetDataLen(&ring), 0);
+}
+
+static void test_put_get(void)
+{
+    run(producer_put, consumer_get);
+}
+
+static void test_reserve_peek(void)
+{
+    run(producer_reserve, consumer_peek);
+}
+
+static void test_put_peek(void)
+{
+    run(producer_put, consumer_peek);
+}
+
+/** length not power of 2 rejected, never rounded down */
+static void test_config_reject(void)
+{
+    MCU_CIRCULAR_SPAN span;
+    uint8_t b = 0x5A;
+
+    CHECK_EQ(MCUCircular_Config(&ring, ring_mem, RING_LEN - 1), -1);
+    CHECK_EQ(MCUCircular_Config(&ring, ring_mem, 0), -1);
+    CHECK_EQ(MCUCircular_GetSpaceLen(&ring), 0);
+    CHECK_EQ(MCUCircular_PutData(&ring, &b, 1), 0);
+    CHECK_EQ(MCUCircular_Reserve(&ring, &span), 0);
+    CHECK_EQ(MCUCircular_GetDataLen(&ring), 0);
+
+    CHECK_EQ(MCUCircular_Config(&ring, ring_mem, RING_LEN), 0);
+    CHECK_EQ(MCUCircular_GetSpaceLen(&ring), RING_LEN);
+}
+
+int main(void)
+{
+    RUN_TEST(test_config_reject);
+    RUN_TEST(test_put_get);
+    RUN_TEST(test_reserve_peek);
+    RUN_TEST(test_put_peek);
+
+    return TEST_RESULT();
+}
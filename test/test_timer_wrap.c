@@ -0,0 +1,190 @@
+/**
+ * @file test_timer_wrap.c
+ * @brief   HAL tick wrap (2^32 ms, 49.7 days) on host
+ *          timer_wheel: one shot, periodic, beyond wheel range and late
+ *          process across wrap, timer_wheel_next() across wrap
+ *          IsTimeout(): elapsed time on tick difference across wrap
+ *
+ *          make -C test build/test_timer_wrap && test/build/test_timer_wrap
+ *          (also run by make -C test)
+ */
+#include "main.h"
+#include "test_util.h"
+#include "utility/timer_wheel.h"
+#include "utility/timeout.h"
+
+int test_failed;
+
+#define TICK_WRAP(ms)   ((uint32_t)(0 - (ms)))  /** tick ms before wrap */
+
+static uint32_t fire_count;
+static uint32_t fire_tick[16];
+
+static void on_fire(TW_Timer_t *timer, void *arg)
+{
+    if (fire_count < sizeof(fire_tick) / sizeof(fire_tick[0]))
+        fire_tick[fire_count] = HAL_GetTick();
+    fire_count++;
+}
+
+static void setup(uint32_t tick)
+{
+    uwTick = tick;
+    fire_count = 0;
+    timer_wheel_init();
+}
+
+/** one timer_wheel_process() every ms */
+static void run_ms(uint32_t ms)
+{
+    while (ms--)
+    {
+        uwTick++;
+        timer_wheel_process();
+    }
+}
+
+static void test_one_shot(void)
+{
+    TW_Timer_t t = { 0 };
+
+    setup(TICK_WRAP(40));
+    timer_wheel_start(&t, 100, 0, on_fire, 0);
+
+    run_ms(99);
+    CHECK_EQ(fire_count, 0);
+    run_ms(1);
+    CHECK_EQ(fire_count, 1);
+    CHECK_EQ(fire_tick[0], 60);
+    run_ms(200);
+    CHECK_EQ(fire_count, 1);
+    CHECK(!timer_wheel_is_running(&t));
+}
+
+/** expire on last tick before wrap and on tick 0 */
+static void test_wrap_edge(void)
+{
+    TW_Timer_t a = { 0 }, b = { 0 };
+
+    setup(TICK_WRAP(1000));
+    timer_wheel_start(&a, 999, 0, on_fire, 0);
+    timer_wheel_start(&b, 1000, 0, on_fire, 0);
+
+    run_ms(999);
+    CHECK_EQ(fire_count, 1);
+    CHECK_EQ(fire_tick[0], 0xFFFFFFFF);
+    run_ms(1);
+    CHECK_EQ(fire_count, 2);
+    CHECK_EQ(fire_tick[1], 0);
+}
+
+static void test_periodic(void)
+{
+    TW_Timer_t t = { 0 };
+    uint32_t i;
+
+    setup(TICK_WRAP(25));
+    timer_wheel_start(&t, 7, 7, on_fire, 0);
+
+    run_ms(7 * 8);
+    CHECK_EQ(fire_count, 8);
+    for (i = 0; i < 8; i++)
+        CHECK_EQ(fire_tick[i], TICK_WRAP(25) + 7 * (i + 1));
+    timer_wheel_stop(&t);
+}
+
+/** timeout beyond wheel range, parked on last level and re-inserted */
+static void test_long_timeout(void)
+{
+    TW_Timer_t t = { 0 };
+    uint32_t range = 1UL << (TW_SLOT_BITS * TW_LEVEL);
+
+    setup(TICK_WRAP(range / 2));
+    timer_wheel_start(&t, range * 2 + 123, 0, on_fire, 0);
+
+    run_ms(range * 2 + 122);
+    CHECK_EQ(fire_count, 0);
+    run_ms(1);
+    CHECK_EQ(fire_count, 1);
+    CHECK_EQ(fire_tick[0], TICK_WRAP(range / 2) + range * 2 + 123);
+}
+
+/** main loop blocked across wrap, every tick caught up on next process */
+static void test_late_process(void)
+{
+    TW_Timer_t a = { 0 }, p = { 0 };
+
+    setup(TICK_WRAP(10));
+    timer_wheel_start(&a, 20, 0, on_fire, 0);
+    timer_wheel_start(&p, 5, 5, on_fire, 0);
+
+    uwTick += 50;
+    timer_wheel_process();
+    /** one shot once, periodic once per elapsed period */
+    CHECK_EQ(fire_count, 1 + 10);
+    CHECK(!timer_wheel_is_running(&a));
+    CHECK(timer_wheel_is_running(&p));
+
+    run_ms(5);
+    CHECK_EQ(fire_count, 12);
+    timer_wheel_stop(&p);
+}
+
+static void test_next(void)
+{
+    TW_Timer_t a = { 0 }, b = { 0 };
+
+    setup(TICK_WRAP(3));
+    CHECK_EQ(timer_wheel_next(), UINT32_MAX);
+
+    timer_wheel_start(&a, 10, 0, on_fire, 0);
+    CHECK_EQ(timer_wheel_next(), 10);
+    run_ms(4);
+    CHECK_EQ(timer_wheel_next(), 6);
+
+    /** upper level, never later than real expiry */
+    timer_wheel_start(&b, 5000, 0, on_fire, 0);
+    timer_wheel_stop(&a);
+    CHECK(timer_wheel_next() <= 5000);
+    CHECK(timer_wheel_next() > 0);
+    timer_wheel_stop(&b);
+}
+
+static void test_is_timeout(void)
+{
+    TIMER t;
+
+    uwTick = TICK_WRAP(100);
+    TimeoutSet(&t, 500);
+    CHECK(!IsTimeout(&t));
+
+    uwTick += 100;                      /** tick 0 */
+    CHECK_EQ(uwTick, 0);
+    CHECK(!IsTimeout(&t));
+
+    uwTick += 399;
+    CHECK(!IsTimeout(&t));
+    uwTick += 1;
+    CHECK(IsTimeout(&t));
+
+    /** set right before wrap, full range timeout */
+    uwTick = TICK_WRAP(1);
+    TimeoutSet(&t, 0xFFFFFFFF);
+    uwTick += 0xFFFFFFFE;
+    CHECK(!IsTimeout(&t));
+    uwTick += 1;
+    CHECK(IsTimeout(&t));
+}
+
+int main(void)
+{
+    RUN_TEST(test_one_shot);
+    RUN_TEST(test_wrap_edge);
+    RUN_TEST(test_periodic);
+    RUN_TEST(test_long_timeout);
+    RUN_TEST(test_late_process);
+    RUN_TEST(test_next);
+    RUN_TEST(test_is_timeout);
+
+    return TEST_RESULT();
+}
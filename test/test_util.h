@@ -0,0 +1,40 @@
+/**
+ * @file test_util.h
+ * @brief   minimal check macro for host test, see. test/Makefile
+ */
+#ifndef TEST_UTIL_H
+#define TEST_UTIL_H
+
+#include <stdio.h>
+
+extern int test_failed;
+
+/** check condition, report and count failure, test keep running */
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            printf("  FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            test_failed++; \
+        } \
+    } while (0)
+
+#define CHECK_EQ(a, b) \
+    do { \
+        long long _a = (long long)(a), _b = (long long)(b); \
+        if (_a != _b) { \
+            printf("  FAIL %s:%d: %s == %s (%lld != %lld)\n", __FILE__, __LINE__, #a, #b, _a, _b); \
+            test_failed++; \
+        } \
+    } while (0)
+
+#define RUN_TEST(fn) \
+    do { \
+        printf("%s\n", #fn); \
+        fn(); \
+    } while (0)
+
+/** test main return, 0: all check passed */
+#define TEST_RESULT() \
+    (printf("%s\n", test_failed ? "FAILED" : "PASSED"), test_failed ? 1 : 0)
+
+#endif /* TEST_UTIL_H */
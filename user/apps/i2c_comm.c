@@ -0,0 +1,676 @@
+/**
+ * @file i2c_comm.c
+ * @author cosmas e.s
+ * @brief   i2c register map, table driven register access from i2c master
+ * @version 0.1
+ * @date 2024-06-10
+ * 
+ * @copyright Copyright (c) 2024
+ * 
+ */
+#include <string.h>
+#include "i2c_comm.h"
+#include "drivers/uart/fs_comm.h"
+#include "app_event_message.h"
+#include "sys_app.h"
+#include "ui/led_indicator/Animation_Style.h"
+#include "ui/led_indicator/led_animation.h"
+#include "utility/cycle_counter.h"
+#include "utility/crc.h"
+#include "utility/low_power.h"
+
+#define ARRAY_LEN(x)        (sizeof(x) / sizeof((x)[0]))
+
+/** working copy of register map, updated by main loop and master write */
+uint8_t I2C_Registers[I2C_REGISTER_MAP_LEN];
+ReadRegister_t *read_reg;
+DiagRegister_t *diag_reg;
+FsDiagRegister_t *fs_diag_reg;
+PowerDiagRegister_t *pwr_diag_reg;
+EvqDiagRegister_t *evq_diag_reg;
+SchDiagRegister_t *sch_diag_reg;
+
+_Static_assert(sizeof(((EvqDiagRegister_t *)0)->lost) == EVQ_PRIO_NUM, "EvqDiagRegister_t lane count mismatch EVQ_PRIO_NUM");
+
+/** register bank served to master read
+ * main loop copy working register to idle bank then swap bank_active,
+ * each read transaction latch one bank so master never get torn status
+ */
+static uint8_t i2c_register_bank[2][I2C_REGISTER_MAP_LEN];
+static uint8_t * volatile bank_active = i2c_register_bank[0];
+static uint8_t * volatile bank_reading = NULL;   /** bank used by ongoing read */
+
+/** register changed and not yet read by master, see. REG_CHANGE_FLAGS */
+static volatile uint8_t change_pending;
+
+/** deferred register write, handler too slow for i2c interrupt 
+ * (e.g. blocking uart send) 
+ */
+typedef struct
+{
+    const I2C_RegDesc_t *desc;
+    uint8_t offset;
+    uint8_t len;
+    uint8_t data[I2C_WRITE_QUEUE_DATA_LEN];
+} I2C_WriteCmd_t;
+
+/** single producer (i2c interrupt), single consumer (main loop) queue
+ * free running index, only producer write head and only consumer write tail
+ */
+static I2C_WriteCmd_t write_queue[I2C_WRITE_QUEUE_LEN];
+static volatile uint8_t write_head;
+static volatile uint8_t write_tail;
+static uint8_t write_queue_max;
+static uint8_t write_queue_drop;
+static SCH_Task_t *write_task;      /** signaled on queued write, NULL: none */
+
+#if (CONFIG_I2C_PEC_ENABLE)
+/** read data staged with PEC, see. i2c_read_stage_pec */
+static uint8_t read_pec_stage[I2C_READ_PEC_DATA_LEN + 1];
+
+/** read group, master read from any register of group get data till
+ * group end then PEC (read length known to both side, see. SMBus block)
+ * independent of write descriptor, status register read on one burst
+ * register outside any group read as single byte then PEC
+ */
+typedef struct
+{
+    uint8_t addr;
+    uint8_t len;
+} I2C_ReadGroup_t;
+
+static const I2C_ReadGroup_t i2c_read_group[] =
+{
+    /* addr                 len */
+    { REG_FIRMWARE_ID,      REG_DIAG_BASE - REG_FIRMWARE_ID },      /** status, setting, generation */
+    { REG_DIAG_BASE,        sizeof(DiagRegister_t) },
+    { REG_CHANGE_FLAGS,     1 },
+    { REG_PWR_DIAG_BASE,    sizeof(PowerDiagRegister_t) },
+    { REG_EVQ_DIAG_BASE,    sizeof(EvqDiagRegister_t) },
+    { REG_FS_DIAG_BASE,     sizeof(FsDiagRegister_t) },
+    { REG_LED_FRAME_BASE,   REG_LED_FRAME_LEN + 1 },                /** frame and commit */
+    { REG_SCH_DIAG_BASE,    sizeof(SchDiagRegister_t) + 1 },        /** statistic and reset */
+};
+
+/** register address to read group lookup (index + 1, 0: no group) */
+static uint8_t read_group_index[I2C_REGISTER_MAP_LEN];
+#endif
+static uint8_t pec_error_count;
+
+static void reg_write_key_command(const I2C_RegDesc_t *desc, uint8_t offset, const uint8_t *data, uint8_t len);
+static void reg_write_volume(const I2C_RegDesc_t *desc, uint8_t offset, const uint8_t *data, uint8_t len);
+static void reg_write_aux1(const I2C_RegDesc_t *desc, uint8_t offset, const uint8_t *data, uint8_t len);
+static void reg_write_led(const I2C_RegDesc_t *desc, uint8_t offset, const uint8_t *data, uint8_t len);
+static void reg_write_led_frame_commit(const I2C_RegDesc_t *desc, uint8_t offset, const uint8_t *data, uint8_t len);
+static void reg_write_sch_stat_reset(const I2C_RegDesc_t *desc, uint8_t offset, const uint8_t *data, uint8_t len);
+
+/**
+ * register map, one entry for each register (or register group)
+ * read:  master read from published bank (see. i2c_register_publish)
+ * write: checked with access right and min/max, then passed to write handler
+ */
+static const I2C_RegDesc_t i2c_register_map[] =
+{
+    /* addr                 width                       access                              min                     max                     write handler */
+    { REG_SYSTEM_REQ,       1,                          REG_ACCESS_RO,                      0x00,                   0xFF,                   NULL },
+    { REG_ERROR_FLAG,       1,                          REG_ACCESS_RO,                      0x00,                   0xFF,                   NULL },
+    { REG_KEY_COMMAND,      1,                          REG_ACCESS_CMD | REG_ACCESS_DEFER,  KEY_CMD_UNMUTE,         KEY_CMD_FACTORY_RESET,  reg_write_key_command },
+    { REG_VOLUME_SET,       1,                          REG_ACCESS_CMD | REG_ACCESS_DEFER,  0,                      32,                     reg_write_volume },
+    { REG_MODE,             6,                          REG_ACCESS_RO,                      0x00,                   0xFF,                   NULL },
+    { REG_AUXILIARY1,       1,                          REG_ACCESS_RW,                      0x00,                   0x01,                   reg_write_aux1 },
+    { REG_AUXILIARY2,       1,                          REG_ACCESS_RW,                      0x00,                   0xFF,                   NULL },
+    { REG_LED_RED,          3,                          REG_ACCESS_RW,                      0x00,                   0xFF,                   reg_write_led },
+    { REG_GENERATION,       1,                          REG_ACCESS_RO,                      0x00,                   0xFF,                   NULL },
+    { REG_DIAG_BASE,        sizeof(DiagRegister_t),     REG_ACCESS_RO,                      0x00,                   0xFF,                   NULL },
+    { REG_CHANGE_FLAGS,     1,                          REG_ACCESS_RO,                      0x00,                   0xFF,                   NULL },
+    { REG_PWR_DIAG_BASE,    sizeof(PowerDiagRegister_t),REG_ACCESS_RO,                      0x00,                   0xFF,                   NULL },
+    { REG_EVQ_DIAG_BASE,    sizeof(EvqDiagRegister_t),  REG_ACCESS_RO,                      0x00,                   0xFF,                   NULL },
+    { REG_FS_DIAG_BASE,     sizeof(FsDiagRegister_t),   REG_ACCESS_RO,                      0x00,                   0xFF,                   NULL },
+    { REG_LED_FRAME_BASE,   REG_LED_FRAME_LEN,          REG_ACCESS_RW,                      0x00,                   0xFF,                   NULL },
+    { REG_LED_FRAME_COMMIT, 1,                          REG_ACCESS_RW | REG_ACCESS_DEFER,   0x00,                   0x01,                   reg_write_led_frame_commit },
+    { REG_SCH_DIAG_BASE,    sizeof(SchDiagRegister_t),  REG_ACCESS_RO,                      0x00,                   0xFF,                   NULL },
+    { REG_SCH_STAT_RESET,   1,                          REG_ACCESS_CMD | REG_ACCESS_DEFER,  0x01,                   0x01,                   reg_write_sch_stat_reset },
+};
+
+/** register address to descriptor lookup (index + 1, 0: no register)
+ * build once at init, so dispatch cost does not grow with register map
+ */
+static uint8_t reg_index[I2C_REGISTER_MAP_LEN];
+
+/***
+ * @brief   parsing key command 
+ *          key with task handling (volume, playback, factory reset) posted
+ *          as event, see. task_key_command(), other sent directly to venice x
+ * @param   none
+ */
+static void parsing_key_command(uint8_t data)
+{
+    switch( data ) {
+        case KEY_CMD_UNMUTE:
+            fs_comm_send_command(KC_UNMUTE, KC_EVENT_KEY_PRESSED);
+            break;
+
+        case KEY_CMD_MUTE:
+            fs_comm_send_command(KC_MUTE, KC_EVENT_KEY_PRESSED);
+            break;
+
+        case KEY_CMD_SPOTIFY_MODE:
+            fs_comm_send_command(KC_SPOTIFY_MODE, KC_EVENT_KEY_PRESSED);
+            break;
+
+        case KEY_CMD_BLUETOOTH_MODE:
+            fs_comm_send_command(KC_BLUETOOTH_MODE, KC_EVENT_KEY_PRESSED);
+            break;
+
+        case KEY_CMD_VOLUME_UP:
+            event_queue_post_u8(&app_event_queue, EVQ_PRIO_NORMAL, MSG_VOL_UP, EVENT_SRC_I2C, data);
+            break;
+
+        case KEY_CMD_VOLUME_DOWN:
+            event_queue_post_u8(&app_event_queue, EVQ_PRIO_NORMAL, MSG_VOL_DW, EVENT_SRC_I2C, data);
+            break;
+
+        case KEY_CMD_PLAY_PAUSE:
+            event_queue_post_u8(&app_event_queue, EVQ_PRIO_NORMAL, MSG_PLAY_PAUSE, EVENT_SRC_I2C, data);
+            break;
+
+        case KEY_CMD_NEXT:
+            event_queue_post_u8(&app_event_queue, EVQ_PRIO_NORMAL, MSG_NEXT, EVENT_SRC_I2C, data);
+            break;
+
+        case KEY_CMD_PREVIOUS:
+            event_queue_post_u8(&app_event_queue, EVQ_PRIO_NORMAL, MSG_PRE, EVENT_SRC_I2C, data);
+            break;
+
+        case KEY_CMD_RESET_NETWORK:
+            fs_comm_send_command(KC_RESET_NETWORK, KC_EVENT_KEY_PRESSED);
+            break;
+
+        case KEY_CMD_FACTORY_RESET:
+            event_queue_post_u8(&app_event_queue, EVQ_PRIO_HIGH, MSG_FACTORY_RESET, EVENT_SRC_I2C, data);
+            break;
+
+        default: break;
+    }
+}
+
+static void reg_write_key_command(const I2C_RegDesc_t *desc, uint8_t offset, const uint8_t *data, uint8_t len)
+{
+    parsing_key_command( data[0] );
+}
+
+/***
+ * @brief   volume set, value already limited by register map (0 - 32)
+ */
+static void reg_write_volume(const I2C_RegDesc_t *desc, uint8_t offset, const uint8_t *data, uint8_t len)
+{
+    fs_comm_send_command(KC_SET_VOLUME, data[0]);
+}
+
+/***
+ * @brief   auxiliary 1, 0: turn off user led, 1: turn on user led
+ */
+static void reg_write_aux1(const I2C_RegDesc_t *desc, uint8_t offset, const uint8_t *data, uint8_t len)
+{
+    HAL_GPIO_WritePin(USER_LED_GPIO_Port, USER_LED_Pin, data[0]);
+}
+
+/***
+ * @brief   led color, R G B already stored on register map
+ *          color updated once for whole burst
+ */
+static void reg_write_led(const I2C_RegDesc_t *desc, uint8_t offset, const uint8_t *data, uint8_t len)
+{
+    dispProp.color = RGB_TO_GRB(I2C_Registers[REG_LED_RED], 
+                                I2C_Registers[REG_LED_GREEN], 
+                                I2C_Registers[REG_LED_BLUE]);
+}
+
+/***
+ * @brief   LED frame commit, latch framebuffer window to LED output
+ *          1: show frame, 0: back to LED animation
+ * @note    deferred, run from main loop together with LED update
+ */
+static void reg_write_led_frame_commit(const I2C_RegDesc_t *desc, uint8_t offset, const uint8_t *data, uint8_t len)
+{
+    /** master may write next frame while latched */
+    __disable_irq();
+    led_host_frame_commit(&I2C_Registers[REG_LED_FRAME_BASE], data[0]);
+    __enable_irq();
+}
+
+/***
+ * @brief   clear scheduler statistic, every task and idle count
+ * @note    deferred, task statistic also updated from main loop
+ */
+static void reg_write_sch_stat_reset(const I2C_RegDesc_t *desc, uint8_t offset, const uint8_t *data, uint8_t len)
+{
+    SCH_Task_t *task;
+
+    for (task = scheduler.task; task; task = task->next)
+    {
+        scheduler_stat_reset(task);
+    }
+    scheduler.idle_count = 0;
+}
+
+/***
+ * @brief   get register descriptor
+ * @param   addr    register address
+ * @return  descriptor, NULL if no register on this address
+ */
+static const I2C_RegDesc_t *i2c_get_register(uint8_t addr)
+{
+    if (addr >= I2C_REGISTER_MAP_LEN || reg_index[addr] == 0)
+        return NULL;
+
+    return (&i2c_register_map[reg_index[addr] - 1]);
+}
+
+/***
+ * @brief   drive host interrupt line, asserted (low) while change pending
+ */
+static void i2c_host_int_update(void)
+{
+#if (CONFIG_I2C_HOST_INT_ENABLE)
+    HAL_GPIO_WritePin(HOST_INT_GPIO_Port, HOST_INT_Pin, 
+                        change_pending ? GPIO_PIN_RESET : GPIO_PIN_SET);
+#endif
+}
+
+#if (CONFIG_I2C_PEC_ENABLE)
+/***
+ * @brief   stage register from reg till end of its read group
+ *          (see. i2c_read_group), followed by PEC
+ *          PEC: [addr+W] [reg] [addr+R] [data ...]
+ * @param   bank    register bank
+ * @param   reg     start register
+ * @param   len     number of staged byte, PEC included
+ * @return  staged buffer
+ */
+static uint8_t *i2c_read_stage_pec(const uint8_t *bank, uint8_t reg, uint8_t *len)
+{
+    const I2C_ReadGroup_t *group;
+    uint8_t n, crc;
+
+    if (reg < I2C_REGISTER_MAP_LEN && read_group_index[reg])
+    {
+        group = &i2c_read_group[read_group_index[reg] - 1];
+        n = group->addr + group->len - reg;
+    }
+    else
+        n = 1;
+    if (n > I2C_READ_PEC_DATA_LEN)
+        n = I2C_READ_PEC_DATA_LEN;
+
+    memcpy(read_pec_stage, &bank[reg], n);
+
+    crc = crc8_update(0, i2c_slave.address & 0xFE);
+    crc = crc8_update(crc, reg);
+    crc = crc8_update(crc, i2c_slave.address | 0x01);
+    read_pec_stage[n] = crc8(crc, read_pec_stage, n);
+
+    *len = n + 1;
+    return (read_pec_stage);
+}
+
+/***
+ * @brief   check and strip PEC of master write
+ *          PEC: [addr+W] [reg] [data ...]
+ * @param   p   received burst, last data byte is PEC
+ * @return  1: valid, p->len without PEC
+ *          0: PEC mismatch
+ */
+static uint8_t i2c_write_check_pec(I2C_Data_t *p)
+{
+    uint8_t crc;
+
+    crc = crc8_update(0, i2c_slave.address & 0xFE);
+    crc = crc8_update(crc, p->reg);
+    crc = crc8(crc, p->data, p->len - 1);
+
+    if (crc != p->data[p->len - 1])
+    {
+        pec_error_count++;
+        return 0;
+    }
+
+    p->len -= 1;
+    return 1;
+}
+#endif
+
+/***
+ * @brief   master read start, latch current bank for whole transaction
+ * @param   reg     start register
+ * @param   len     number of byte available from reg
+ * @note    called from i2c interrupt
+ */
+static uint8_t *i2c_read_begin(uint8_t reg, uint8_t *len)
+{
+    bank_reading = bank_active;
+
+#if (CONFIG_I2C_PEC_ENABLE)
+    return (i2c_read_stage_pec(bank_reading, reg, len));
+#else
+    *len = I2C_REGISTER_MAP_LEN - reg;
+    return (bank_reading + reg);
+#endif
+}
+
+/***
+ * @brief   master read end, bank can be reused by publisher
+ * @note    called from i2c interrupt
+ */
+static void i2c_read_end(uint8_t reg, uint8_t count)
+{
+    /** change flags read by master, clear only flags served on this bank,
+     * change after publish still pending
+     */
+    if (bank_reading && reg <= REG_CHANGE_FLAGS && reg + count > REG_CHANGE_FLAGS)
+    {
+        change_pending &= ~bank_reading[REG_CHANGE_FLAGS];
+        i2c_host_int_update();
+    }
+    bank_reading = NULL;
+}
+
+static const I2C_ReadCallback_t i2c_read_callback =
+{
+    .begin = i2c_read_begin,
+    .end = i2c_read_end,
+};
+
+/***
+ * @brief   publish working register to master read
+ *          generation increment when status / setting register changed,
+ *          diagnostic register is published without new generation
+ */
+static void i2c_register_publish(void)
+{
+    uint8_t *next;
+    uint8_t changed = 0;
+    uint8_t i;
+
+    next = (bank_active == i2c_register_bank[0]) ? i2c_register_bank[1] : i2c_register_bank[0];
+
+    /** master still reading older generation from this bank, try on next pass */
+    if (bank_reading == next)
+        return;
+
+    for (i = 0; i < 8; i++)
+    {
+        if ((REG_CHANGE_WATCH & REG_CHANGE_BIT(i)) && I2C_Registers[i] != bank_active[i])
+            changed |= REG_CHANGE_BIT(i);
+    }
+
+    /** change_pending also cleared from i2c interrupt */
+    __disable_irq();
+    change_pending |= changed;
+    I2C_Registers[REG_CHANGE_FLAGS] = change_pending;
+    __enable_irq();
+
+    if (memcmp(I2C_Registers, bank_active, REG_GENERATION) != 0)
+    {
+        I2C_Registers[REG_GENERATION]++;
+    }
+    else if (memcmp(I2C_Registers, bank_active, I2C_REGISTER_MAP_LEN) == 0)
+    {
+        /** nothing changed */
+        return;
+    }
+
+    memcpy(next, I2C_Registers, I2C_REGISTER_MAP_LEN);
+    bank_active = next;
+
+    /** notify host after new change flags visible on bus */
+    i2c_host_int_update();
+}
+
+/***
+ * @brief   queue register write, handler called later from main loop
+ * @note    called from i2c interrupt (producer)
+ */
+static void i2c_write_enqueue(const I2C_RegDesc_t *desc, uint8_t offset, const uint8_t *data, uint8_t len)
+{
+    I2C_WriteCmd_t *cmd;
+    uint8_t head = write_head;
+    uint8_t depth = (uint8_t)(head - write_tail);
+
+    if (depth >= I2C_WRITE_QUEUE_LEN || len > I2C_WRITE_QUEUE_DATA_LEN)
+    {
+        write_queue_drop++;
+        return;
+    }
+
+    cmd = &write_queue[head & (I2C_WRITE_QUEUE_LEN - 1)];
+    cmd->desc = desc;
+    cmd->offset = offset;
+    cmd->len = len;
+    memcpy(cmd->data, data, len);
+
+    /** entry complete before visible to consumer */
+    __DMB();
+    write_head = head + 1;
+
+    if (depth + 1 > write_queue_max)
+    {
+        write_queue_max = depth + 1;
+    }
+
+    if (write_task)
+    {
+        scheduler_signal(write_task);
+    }
+}
+
+/***
+ * @brief   run deferred register write
+ * @note    called from main loop (consumer)
+ */
+static void i2c_write_dispatch(void)
+{
+    I2C_WriteCmd_t *cmd;
+
+    while (write_tail != write_head)
+    {
+        __DMB();
+        cmd = &write_queue[write_tail & (I2C_WRITE_QUEUE_LEN - 1)];
+        cmd->desc->write(cmd->desc, cmd->offset, cmd->data, cmd->len);
+
+        /** entry consumed before slot released to producer */
+        __DMB();
+        write_tail++;
+    }
+}
+
+/***
+ * @brief   flag illegal write on diagnostic register
+ */
+static void i2c_write_error(uint8_t addr)
+{
+    diag_reg->write_err_count++;
+    diag_reg->write_err_addr = addr;
+}
+
+/***
+ * @brief   process and parsing data received from i2c master
+ *          burst write: p->data[i] written to register (p->reg + i)
+ *          burst is split per register descriptor, so each handler called
+ *          once for its register (e.g. R,G,B in one call)
+ * @param   p   received burst
+ */
+static void i2c_communication_process(I2C_Data_t *p)
+{
+    const I2C_RegDesc_t *desc;
+    uint8_t addr, pos, len, i;
+
+    if (!p) return;
+
+#if (CONFIG_I2C_PEC_ENABLE)
+    if (!i2c_write_check_pec(p)) return;
+#endif
+
+    addr = p->reg;
+    pos = 0;
+
+    while (pos < p->len)
+    {
+        desc = i2c_get_register(addr);
+
+        if (!desc || !(desc->access & REG_ACCESS_W))
+        {
+            i2c_write_error(addr);
+            addr++;
+            pos++;
+            continue;
+        }
+
+        /** number of byte belong to this descriptor */
+        len = desc->addr + desc->width - addr;
+        if (len > p->len - pos)
+            len = p->len - pos;
+
+        for (i = 0; i < len; i++)
+        {
+            if (p->data[pos + i] < desc->min || p->data[pos + i] > desc->max)
+                break;
+        }
+
+        if (i < len)
+        {
+            /** value out of range, reject whole register */
+            i2c_write_error(addr + i);
+        }
+        else
+        {
+            if (desc->access & REG_ACCESS_STORE)
+            {
+                memcpy(&I2C_Registers[addr], &p->data[pos], len);
+            }
+
+            if (desc->write && (desc->access & REG_ACCESS_DEFER))
+            {
+                i2c_write_enqueue(desc, addr - desc->addr, &p->data[pos], len);
+            }
+            else if (desc->write)
+            {
+                desc->write(desc, addr - desc->addr, &p->data[pos], len);
+            }
+        }
+
+        addr += len;
+        pos += len;
+    }
+}
+
+/***
+ * @brief   i2c register map init
+ */
+void i2c_comm_init(void)
+{
+    uint8_t i, k;
+
+    for (i = 0; i < ARRAY_LEN(i2c_register_map); i++)
+    {
+        for (k = 0; k < i2c_register_map[i].width; k++)
+        {
+            reg_index[i2c_register_map[i].addr + k] = i + 1;
+        }
+    }
+
+#if (CONFIG_I2C_PEC_ENABLE)
+    for (i = 0; i < ARRAY_LEN(i2c_read_group); i++)
+    {
+        for (k = 0; k < i2c_read_group[i].len; k++)
+        {
+            read_group_index[i2c_read_group[i].addr + k] = i + 1;
+        }
+    }
+#endif
+
+    read_reg = (ReadRegister_t *) &I2C_Registers[REG_FIRMWARE_ID];
+    diag_reg = (DiagRegister_t *) &I2C_Registers[REG_DIAG_BASE];
+    fs_diag_reg = (FsDiagRegister_t *) &I2C_Registers[REG_FS_DIAG_BASE];
+    pwr_diag_reg = (PowerDiagRegister_t *) &I2C_Registers[REG_PWR_DIAG_BASE];
+    evq_diag_reg = (EvqDiagRegister_t *) &I2C_Registers[REG_EVQ_DIAG_BASE];
+    sch_diag_reg = (SchDiagRegister_t *) &I2C_Registers[REG_SCH_DIAG_BASE];
+
+    memcpy(bank_active, I2C_Registers, I2C_REGISTER_MAP_LEN);
+
+    /** init I2C Slave */
+    i2c_slave_init( i2c_communication_process , &i2c_read_callback, I2C_REGISTER_MAP_LEN);
+}
+
+/***
+ * @brief   set task running i2c_comm_handler(), signaled on deferred
+ *          register write so write not wait for next period
+ */
+void i2c_comm_attach_task(SCH_Task_t *task)
+{
+    write_task = task;
+}
+
+/***
+ * @brief   i2c communication handler, run deferred register write, 
+ *          update diagnostic register and publish register map to master
+ *          call at end of main loop, after all register updated
+ */
+void i2c_comm_handler(void)
+{
+    SCH_Task_t *task;
+    uint32_t time_us;
+    uint8_t prio, i;
+
+    i2c_slave_bus_monitor();
+    i2c_write_dispatch();
+
+    diag_reg->irq_per_xfer = (uint8_t) i2c_slave.irq_per_xfer;
+    diag_reg->irq_per_xfer_max = (uint8_t) i2c_slave.irq_per_xfer_max;
+
+    time_us = CYCLE_TO_US(i2c_slave.isr_cycles_max);
+    diag_reg->isr_time_max = (time_us > 0xFFFF) ? 0xFFFF : (uint16_t) time_us;
+    diag_reg->write_queue_max = write_queue_max;
+    diag_reg->write_queue_drop = write_queue_drop;
+    diag_reg->stretch_overrun = (uint8_t) i2c_slave.stretch_overrun;
+    diag_reg->pec_error_count = pec_error_count;
+    diag_reg->bus_recover_count = (uint8_t) i2c_slave.bus_recover_count;
+    diag_reg->bus_stuck_cause = i2c_slave.bus_stuck_cause;
+    diag_reg->fs_rx_irq_per_frame = (uint8_t) FS.rx_irq_per_frame;
+    diag_reg->fs_tx_drop = (uint8_t) FS.tx_drop;
+    time_us = CYCLE_TO_US(FS.tx_block_cycles_max);
+    diag_reg->fs_tx_block_max = (time_us > 0xFFFF) ? 0xFFFF : (uint16_t) time_us;
+
+    fs_diag_reg->rx_overrun = (uint8_t) FS.rx_overrun;
+    fs_diag_reg->rx_frame_error = (uint8_t) FS.rx_frame_error;
+    fs_diag_reg->rx_noise_error = (uint8_t) FS.rx_noise_error;
+    fs_diag_reg->rx_overflow = (uint8_t) FS.rx_overflow;
+    fs_diag_reg->rx_level_max = FS.rx_level_max;
+    fs_diag_reg->rx_crc_error = (uint8_t) FS.rx_crc_error;
+    fs_diag_reg->rx_partial_drop = (uint8_t) FS.rx_partial_drop;
+    fs_diag_reg->rx_discard = (uint16_t) FS.rx_discard;
+    fs_diag_reg->status_change_latency_max = (FS.poll.change_latency_max > 0xFFFF) ? 0xFFFF : (uint16_t) FS.poll.change_latency_max;
+    fs_diag_reg->status_key_latency_max = (FS.poll.key_latency_max > 0xFFFF) ? 0xFFFF : (uint16_t) FS.poll.key_latency_max;
+
+    pwr_diag_reg->sleep_residency = low_power.residency;
+    pwr_diag_reg->wakeup_count = low_power.wakeup;
+    pwr_diag_reg->sleep_max = (low_power.sleep_ms_max > 0xFFFF) ? 0xFFFF : (uint16_t) low_power.sleep_ms_max;
+
+    for (prio = 0; prio < EVQ_PRIO_NUM; prio++)
+    {
+        evq_diag_reg->lost[prio] = (app_event_queue.Lost[prio] > 0xFF) ? 0xFF : (uint8_t) app_event_queue.Lost[prio];
+        evq_diag_reg->level_max[prio] = app_event_queue.LevelMax[prio];
+    }
+
+    /** task slot on scheduler order, task beyond last slot not shown */
+    for (i = 0, task = scheduler.task; task && i < REG_SCH_DIAG_TASK; i++, task = task->next)
+    {
+        time_us = CYCLE_TO_US(task->run_cycles_max);
+        sch_diag_reg->task[i].run_time_max = (time_us > 0xFFFF) ? 0xFFFF : (uint16_t) time_us;
+        sch_diag_reg->task[i].jitter_max = (task->jitter_max > 0xFF) ? 0xFF : (uint8_t) task->jitter_max;
+        sch_diag_reg->task[i].deadline_miss = (uint8_t) task->deadline_miss;
+    }
+    sch_diag_reg->idle_count = (uint16_t) scheduler.idle_count;
+
+    i2c_register_publish();
+}
@@ -13,9 +13,54 @@
 
 
 #include "drivers/i2c/i2c_slave.h"
+#include "app_config.h"
+#include "utility/scheduler.h"
 
 
-/** register list based on frontier silicon */
+/** register address space, read and write share one register map
+ * see. i2c_register_map[] in i2c_comm.c
+ */
+#define I2C_REGISTER_MAP_LEN    0x80
+
+/** register access right */
+#define REG_ACCESS_R        (1<<0)  /** readable by master */
+#define REG_ACCESS_W        (1<<1)  /** writable by master, passed to write handler */
+#define REG_ACCESS_STORE    (1<<2)  /** written value latched to register map (read back) */
+#define REG_ACCESS_DEFER    (1<<3)  /** write handler run from main loop (see. i2c write queue) */
+
+#define REG_ACCESS_RO       (REG_ACCESS_R)
+#define REG_ACCESS_RW       (REG_ACCESS_R | REG_ACCESS_W | REG_ACCESS_STORE)
+/** write is a command, read return status on same address */
+#define REG_ACCESS_CMD      (REG_ACCESS_R | REG_ACCESS_W)
+
+/** queue of deferred register write, from i2c interrupt to main loop
+ * length must be power of 2
+ */
+#define I2C_WRITE_QUEUE_LEN         8
+/** max data of one deferred write, deferred register width must not exceed */
+#define I2C_WRITE_QUEUE_DATA_LEN    4
+
+/** max register byte on one read when PEC enabled (PEC not included),
+ * largest read group: LED framebuffer and commit (see. i2c_read_group)
+ */
+#define I2C_READ_PEC_DATA_LEN       (REG_LED_FRAME_LEN + 1)
+
+/** read register list, see. ReadRegister_t */
+#define REG_FIRMWARE_ID     0x00
+#define REG_BOOT_INFO       0x01
+#define REG_WIFI_STATUS     0x02
+#define REG_BT_STATUS       0x03
+#define REG_MODE            0x04
+#define REG_SPOTIFY_STATUS  0x05
+#define REG_VOLUME          0x06
+#define REG_ERROR_STATUS    0x07
+#define REG_AUX1_DATA       0x08
+#define REG_AUX2_DATA       0x09
+
+/** write register list based on frontier silicon
+ * REG_SYSTEM_REQ, REG_ERROR_FLAG: no write handler yet, read only
+ * (read as REG_BOOT_INFO, REG_WIFI_STATUS), write reported as error
+ */
 #define REG_SYSTEM_REQ      0x00
 #define REG_ERROR_FLAG      0x01
 #define REG_KEY_COMMAND     0x02
@@ -32,6 +77,86 @@
 #define REG_LED_GREEN       0x0D
 #define REG_LED_BLUE        0x0E
 
+/** generation counter, rolling
+ * incremented each time register 0x00 - 0x0E published with new value,
+ * master can skip read when generation not changed
+ */
+#define REG_GENERATION      0x0F
+
+/** diagnostic register, see. DiagRegister_t */
+#define REG_DIAG_BASE       0x10
+
+/** change flags, clear on read
+ * bit n set when read register n changed (see. REG_CHANGE_WATCH),
+ * bit cleared after master read this register, HOST_INT asserted while
+ * any bit set
+ */
+#define REG_CHANGE_FLAGS    0x20
+
+/** power diagnostic register, see. PowerDiagRegister_t */
+#define REG_PWR_DIAG_BASE   0x24
+#define REG_PWR_DIAG_LEN    6       /** sizeof(PowerDiagRegister_t) */
+
+/** application event queue diagnostic register, see. EvqDiagRegister_t */
+#define REG_EVQ_DIAG_BASE   0x2A
+#define REG_EVQ_DIAG_LEN    6       /** sizeof(EvqDiagRegister_t) */
+
+/** Venice X uart diagnostic register, see. FsDiagRegister_t */
+#define REG_FS_DIAG_BASE    0x30
+#define REG_FS_DIAG_LEN     14      /** sizeof(FsDiagRegister_t) */
+
+/** LED framebuffer window, R G B for each LED (CONFIG_LED_NUMBER)
+ * master burst whole frame then write 1 to REG_LED_FRAME_COMMIT (may be
+ * on same burst), frame shown on next LED update tick
+ * write 0 to REG_LED_FRAME_COMMIT back to LED animation
+ */
+#define REG_LED_FRAME_BASE      0x40
+#define REG_LED_FRAME_LEN       (CONFIG_LED_NUMBER * 3)
+#define REG_LED_FRAME_COMMIT    (REG_LED_FRAME_BASE + REG_LED_FRAME_LEN)
+
+/** scheduler diagnostic register, see. SchDiagRegister_t */
+#define REG_SCH_DIAG_BASE   0x68
+#define REG_SCH_DIAG_LEN    18      /** sizeof(SchDiagRegister_t) */
+#define REG_SCH_DIAG_TASK   4       /** task slot, see. main_task_init() */
+
+/** write 1 to clear scheduler diagnostic (see. scheduler_stat_reset()),
+ * read as 0
+ */
+#define REG_SCH_STAT_RESET  (REG_SCH_DIAG_BASE + REG_SCH_DIAG_LEN)
+
+#if (REG_PWR_DIAG_BASE + REG_PWR_DIAG_LEN > REG_EVQ_DIAG_BASE)
+#error "power diagnostic register overlap event queue diagnostic register"
+#endif
+
+#if (REG_EVQ_DIAG_BASE + REG_EVQ_DIAG_LEN > REG_FS_DIAG_BASE)
+#error "event queue diagnostic register overlap Venice X diagnostic register"
+#endif
+
+#if (REG_FS_DIAG_BASE + REG_FS_DIAG_LEN > REG_LED_FRAME_BASE)
+#error "Venice X diagnostic register overlap LED framebuffer"
+#endif
+
+#if (REG_LED_FRAME_COMMIT >= REG_SCH_DIAG_BASE)
+#error "LED framebuffer overlap scheduler diagnostic register"
+#endif
+
+#if (REG_SCH_STAT_RESET >= I2C_REGISTER_MAP_LEN)
+#error "scheduler diagnostic register exceed I2C register map"
+#endif
+
+#if (REG_SCH_DIAG_LEN + 1 > I2C_READ_PEC_DATA_LEN) || (REG_FS_DIAG_LEN > I2C_READ_PEC_DATA_LEN)
+#error "read group exceed PEC stage buffer (see. I2C_READ_PEC_DATA_LEN)"
+#endif
+
+#define REG_CHANGE_BIT(reg) (1 << (reg))
+#define REG_CHANGE_WATCH    (REG_CHANGE_BIT(REG_BOOT_INFO)      | \
+                             REG_CHANGE_BIT(REG_WIFI_STATUS)    | \
+                             REG_CHANGE_BIT(REG_BT_STATUS)      | \
+                             REG_CHANGE_BIT(REG_MODE)           | \
+                             REG_CHANGE_BIT(REG_SPOTIFY_STATUS) | \
+                             REG_CHANGE_BIT(REG_VOLUME)         | \
+                             REG_CHANGE_BIT(REG_ERROR_STATUS))
+
 /** key command definition */
 #define KEY_CMD_UNMUTE          0x01
 #define KEY_CMD_MUTE            0x02
@@ -127,8 +252,188 @@ struct
 
 } ReadRegister_t;
 
-/** prototype function */
+typedef
+struct
+{
+    // reg 0x10
+    uint8_t write_err_count;        // illegal write counter, rolling
+                                    // (read only register, unknown register,
+                                    //  value out of range)
+
+    // reg 0x11
+    uint8_t write_err_addr;         // register address of last illegal write
+
+    // reg 0x12
+    uint8_t irq_per_xfer;           // interrupt count of last I2C transaction
+
+    // reg 0x13
+    uint8_t irq_per_xfer_max;       // worst interrupt count per transaction
+
+    // reg 0x14 - 0x15
+    uint16_t isr_time_max;          // worst I2C interrupt execution time (us)
+
+    // reg 0x16
+    uint8_t write_queue_max;        // write queue depth high-water
+
+    // reg 0x17
+    uint8_t write_queue_drop;       // deferred write dropped (queue full), rolling
+
+    // reg 0x18
+    uint8_t stretch_overrun;        // interrupt exceeded clock stretch budget, rolling
+                                    // (see. I2C_SLAVE_STRETCH_BUDGET_US)
+
+    // reg 0x19
+    uint8_t pec_error_count;        // write rejected on PEC mismatch, rolling
+                                    // (see. CONFIG_I2C_PEC_ENABLE)
+
+    // reg 0x1A
+    uint8_t bus_recover_count;      // stuck bus recovery, rolling
+
+    // reg 0x1B
+    uint8_t bus_stuck_cause;        // cause of last recovery
+                                    // b[0] = 1: SCL held low
+                                    // b[1] = 1: SDA held low
+                                    // b[2] = 1: transaction stalled
+
+    // reg 0x1C
+    uint8_t fs_rx_irq_per_frame;    // uart interrupt on last Venice X frame
+
+    // reg 0x1D
+    uint8_t fs_tx_drop;             // key command dropped, queue full, rolling
+
+    // reg 0x1E - 0x1F
+    uint16_t fs_tx_block_max;       // longest key command send time (us)
+                                    // (main loop blocked by uart send)
 
+} DiagRegister_t;
+
+typedef
+struct
+{
+    // reg 0x30
+    uint8_t rx_overrun;             // uart overrun, byte lost before read, rolling
+
+    // reg 0x31
+    uint8_t rx_frame_error;         // uart framing error, rolling
+
+    // reg 0x32
+    uint8_t rx_noise_error;         // uart noise error, rolling
+
+    // reg 0x33
+    uint8_t rx_overflow;            // receive buffer full, data lost, rolling
+
+    // reg 0x34 - 0x35
+    uint16_t rx_level_max;          // receive buffer high-water (byte)
+                                    // (see. FS_CIRCULAR_BUFF_LEN)
+
+    // reg 0x36
+    uint8_t rx_crc_error;           // extended frame checksum mismatch, rolling
+
+    // reg 0x37
+    uint8_t rx_partial_drop;        // incomplete frame dropped on timeout, rolling
+
+    // reg 0x38 - 0x39
+    uint16_t rx_discard;            // byte discarded on resync, rolling
+
+    // reg 0x3A - 0x3B
+    uint16_t status_change_latency_max; // worst status change seen to previous
+                                        // status reply (ms)
+
+    // reg 0x3C - 0x3D
+    uint16_t status_key_latency_max;    // worst key command to status change (ms)
+
+} FsDiagRegister_t;
+
+typedef
+struct
+{
+    // reg 0x24 - 0x25
+    uint16_t sleep_residency;       // time in sleep on last second (permille)
+
+    // reg 0x26 - 0x27
+    uint16_t wakeup_count;          // sleep entered on last second
+
+    // reg 0x28 - 0x29
+    uint16_t sleep_max;             // longest single sleep (ms)
+
+} PowerDiagRegister_t;
+
+typedef
+struct
+{
+    // reg 0x2A - 0x2C
+    uint8_t lost[3];                // event dropped on full lane, saturated
+                                    // high, normal, low (see. EVQ_PRIO_xxx)
+
+    // reg 0x2D - 0x2F
+    uint8_t level_max[3];           // lane high-water (event)
+                                    // (see. EVQ_LANE_DEPTH)
+
+} EvqDiagRegister_t;
+
+typedef
+struct
+{
+    uint16_t run_time_max;          // worst run time (us)
+    uint8_t jitter_max;             // worst start delay after release (ms), saturated
+    uint8_t deadline_miss;          // run ended after deadline, rolling
+} SchTaskDiag_t;
+
+typedef
+struct
+{
+    // reg 0x68 - 0x77
+    SchTaskDiag_t task[REG_SCH_DIAG_TASK];  // 4 byte per task, scheduler order
+                                            // (priority, then register order)
+                                            // comm, i2c, app, led
+
+    // reg 0x78 - 0x79
+    uint16_t idle_count;            // sleep entered, nothing ready, rolling
+
+} SchDiagRegister_t;
+
+/** register window sized by hand (see. REG_xxx_LEN), keep with struct */
+_Static_assert(sizeof(DiagRegister_t) == REG_CHANGE_FLAGS - REG_DIAG_BASE, "DiagRegister_t size mismatch register window");
+_Static_assert(sizeof(PowerDiagRegister_t) == REG_PWR_DIAG_LEN, "PowerDiagRegister_t size mismatch REG_PWR_DIAG_LEN");
+_Static_assert(sizeof(FsDiagRegister_t) == REG_FS_DIAG_LEN, "FsDiagRegister_t size mismatch REG_FS_DIAG_LEN");
+_Static_assert(sizeof(EvqDiagRegister_t) == REG_EVQ_DIAG_LEN, "EvqDiagRegister_t size mismatch REG_EVQ_DIAG_LEN");
+_Static_assert(sizeof(SchDiagRegister_t) == REG_SCH_DIAG_LEN, "SchDiagRegister_t size mismatch REG_SCH_DIAG_LEN");
+
+typedef struct _i2c_reg_desc I2C_RegDesc_t;
+
+/**
+ * register write handler
+ * @param   desc    register descriptor
+ * @param   offset  offset of first written byte from desc->addr
+ * @param   data    written data, already checked with min/max
+ * @param   len     number of byte, never exceed desc->width - offset
+ */
+typedef void (*reg_write_handler)(const I2C_RegDesc_t *desc, uint8_t offset, const uint8_t *data, uint8_t len);
+
+/** register descriptor */
+struct _i2c_reg_desc
+{
+    uint8_t addr;                   // first register address
+    uint8_t width;                  // number of register (byte)
+    uint8_t access;                 // see. REG_ACCESS_x
+    uint8_t min;                    // min allowed value (each byte)
+    uint8_t max;                    // max allowed value (each byte)
+    reg_write_handler write;        // write handler, NULL: no action
+};
+
+/** prototype function */
+void i2c_comm_init(void);
+void i2c_comm_handler(void);
+void i2c_comm_attach_task(SCH_Task_t *task);
 /** end of prototype function  */
 
+/** extern resource */
+extern ReadRegister_t *read_reg;
+extern DiagRegister_t *diag_reg;
+extern FsDiagRegister_t *fs_diag_reg;
+extern PowerDiagRegister_t *pwr_diag_reg;
+extern EvqDiagRegister_t *evq_diag_reg;
+extern SchDiagRegister_t *sch_diag_reg;
+/** end of extern resource  */
+
 #endif  /** end of I2C_COMM_H */
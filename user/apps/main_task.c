@@ -16,51 +16,60 @@ uint8_t subTaskNetworkState = TASK_STATE_IDLE;
  * is it actually disconnected or just temporary
  * lost connection 
 */
-TIMER tmrWaitConn;
+TW_Timer_t tmrWaitConn;
 
-TIMER tmrIdle;
-TIMER tmrFsVolumeChange;
-TIMER tmrFactoryTimeout;    // timeout if factory reset fail, it will reset flag
-                            // so user can press factory reset again
-TIMER tmrCheckStandbySetupMode;
+TW_Timer_t tmrIdle;
+/** timeout if factory reset fail, posted as MSG_FACTORY_RESET from
+ * EVENT_SRC_TIMER, it will reset flag so user can press factory reset again
+ */
+EVQ_TimerEvent_t evFactoryTimeout;
+static const EVQ_Event_t msgFactoryTimeout = { .eventId = MSG_FACTORY_RESET, .source = EVENT_SRC_TIMER, .type = EVQ_TYPE_NONE };
+#define TIMEOUT_FACTORY_START       5000
+TW_Timer_t tmrCheckStandbySetupMode;
 
 /** this timer used to tricky volume feedback from VX module
  * after increase or decrease volume from local key, VX module wiil reply pre step 
  * so it will caused repetition effect
 */
-TIMER tmrVolumeSync;
+TW_Timer_t tmrVolumeSync;
 
 /*** time used to waiting FS module stable when change function
  * if user press button mode too fast its caused the FS module not be able processed
  * key command bluetoothe and key command spotify
  * FS module take sometime to ready in switch mode
 */
-TIMER tmrWaitChangeMode;
+TW_Timer_t tmrWaitChangeMode;
 /***this timeout timer used for blocking current  function reply
  * from VX module until current function reply from VX stable (latest)
 */
-TIMER tmrBlockingFunctionReplyVx;
+TW_Timer_t tmrBlockingFunctionReplyVx;
 
 
 /** timeout used for auto broadcast mode */
-TIMER tmrAutoBroadcast;
-TIMER tmrSimMaster, tmrSimSlave;
 #define TIMEOUT_BROADCAST_MASTER    6000
 #define TIMEOUT_BROADCAST_SLAVE     6000
 
-/** this timer used to set timeout in broadcast slave mode 
- * and not trigger the volume sync
-*/
-TIMER tmrVolSyncTimeout;
-
 #if 1//(CONFIG_STANDBY_DEPEND_NETWORK_CONNECTION)
 //static TIMER tmrWifiWaitConn;
-static TIMER tmrWaitForWakeup;
+static TW_Timer_t tmrWaitForWakeup;
 #endif
 
-TIMER tmrBroadcastPreventFault;
+TW_Timer_t tmrBroadcastPreventFault;
 
-TIMER tmrUpdateI2CReg;
+TW_Timer_t tmrUpdateI2CReg;
+
+/** scheduler task, see. main_task_init() */
+SCH_Task_t schTaskComm, schTaskI2c, schTaskApp, schTaskLed;
+
+/**
+ * @brief   state timer expired, run state machine now instead of on
+ *          next period, timer wheel callback
+ *          timer running: waiting, stopped / expired: timeout
+*/
+static void main_task_timer_wake(TW_Timer_t *timer, void *arg)
+{
+    scheduler_signal(&schTaskApp);
+}
 uint8_t _reg[12];
 uint16_t counter = 0;
 
@@ -136,6 +145,20 @@ static uint8_t convert_fs_mode(uint8_t fsmode)
  */
 static void do_change_task(uint8_t *state_id, EventContext *ev)
 {
+#if (CONFIG_ENABLE_STANDBY)
+    /** power first, never hidden by pending venice x mode */
+    if (ev->eventId == MSG_POWER)
+    {
+        *state_id = TASK_STATE_STOP;
+        /** backup current function before go to standby */
+        system_config.pre_function = system_config.current_function;
+        system_config.current_function = SYS_MODE_STANDBY;
+
+        /** venice x mode outdated, function restored on wakeup */
+        CLR_FLAG( FLAG_FS_MODE_PENDING );
+    }
+    else
+#endif
     if (ev->eventId == MSG_MODE && *state_id != TASK_STATE_PAUSE)
     {
 
@@ -143,19 +166,23 @@ static void do_change_task(uint8_t *state_id, EventContext *ev)
             return;
             
 #if (CONFIG_ROLLING_MODE)
-        TimeoutSet(&tmrWaitChangeMode, TIMEOUT_FUNCTION_CHANGE);
+        timer_wheel_start(&tmrWaitChangeMode, TIMEOUT_FUNCTION_CHANGE, 0, main_task_timer_wake, NULL);
 #endif // CONFIG_ROLLING_MODE
 
         *state_id = TASK_STATE_STOP;
         system_config.current_function = get_next_mode(system_config.current_function);
     }
-    else if (ev->eventId == MSG_SET_MODE)
+    else if ( GET_FLAG(FLAG_FS_MODE_PENDING) )
     {
-
+        /** set on MSG_SET_MODE (see. task_key_command()), kept until
+         * applied, follow latest venice x mode
+         */
 #if (CONFIG_WAIT_CHANGE_MODE_VENICEX)
-        if ( !IsTimeout(&tmrBlockingFunctionReplyVx) )
+        if ( timer_wheel_is_running(&tmrBlockingFunctionReplyVx) )
             return;
 #endif
+        CLR_FLAG( FLAG_FS_MODE_PENDING );
+
         uint8_t tempFunc = convert_fs_mode(FS.config.data1.bit.mode);
         if ( (system_config.current_function != tempFunc) && (tempFunc != SYS_MODE_IDLE) )
         {
@@ -165,15 +192,6 @@ static void do_change_task(uint8_t *state_id, EventContext *ev)
             SET_FLAG( FLAG_IS_MODE_FROM_FS );
         }
     }
-#if (CONFIG_ENABLE_STANDBY)
-    else if (ev->eventId == MSG_POWER)
-    {
-        *state_id = TASK_STATE_STOP;
-        /** backup current function before go to standby */
-        system_config.pre_function = system_config.current_function;
-        system_config.current_function = SYS_MODE_STANDBY;
-    }
-#endif
     else if(0 /*reserved*/)
     {
 
@@ -195,11 +213,11 @@ static void do_check_standby_and_setup_mode(void)
 {
     if ( fs_comm_get_wifi_status() == FS_WIFI_SETUP_MODE && fs_comm_get_mode() == FS_MODE_STANDBY )
     {
-        if ( IsTimeout(&tmrCheckStandbySetupMode) )
+        if ( !timer_wheel_is_running(&tmrCheckStandbySetupMode) )
         {
             /** wakeup from standby state */
             fs_comm_send_command(KC_STANDBY, KC_EVENT_KEY_PRESSED);
-            TimeoutSet(&tmrCheckStandbySetupMode, 2000);
+            timer_wheel_start(&tmrCheckStandbySetupMode, 2000, 0, NULL, NULL);
         }
     }
 }
@@ -267,38 +285,14 @@ static void task_common(EventContext *ev)
 
     /** @removed: bt broadcast block on slave */
 
-    if ( (system_config.current_function == SYS_MODE_BOOTING && ev->eventId != MSG_FACTORY_RESET) && 
+    if ( system_config.current_function == SYS_MODE_BOOTING && 
             system_config.venicex_state != VENICEX_STATE_READY)
         return;
 
         switch(ev->eventId)
         {
-            /** volume up event id */
-            case MSG_VOL_UP:
-                if (system_config.system_volume < SYS_VOL_MAX)
-                {
-                    system_config.system_volume++;
-                }
-
-
-                TimeoutSet(&tmrVolumeSync, TIMEOUT_VOLUME_TRICK);
-                fs_comm_send_command(KC_VOLUME_UP, KC_EVENT_KEY_PRESSED);
-
-                break;
-
-            /** volume down event id */
-            case MSG_VOL_DW:
-                if (system_config.system_volume > 0)
-                {
-                    system_config.system_volume--;
-                }
-
-                TimeoutSet(&tmrVolumeSync, TIMEOUT_VOLUME_TRICK);
-                fs_comm_send_command(KC_VOLUME_DOWN, KC_EVENT_KEY_PRESSED);
+            /** key command handled before task, see. task_key_command() */
 
-                /** @removed: bt broadcast */
-                break;
-            
             /** set to direct value */
             case MSG_BT_BROADCAST_SYNC_VOL: /**  message from bt broadcast sync */
             case MSG_FS_VOL_SET: /** message source from FS uart event */
@@ -313,22 +307,10 @@ static void task_common(EventContext *ev)
                 }
                 break;
 
-            case MSG_PLAY_PAUSE:
-                fs_comm_send_command(KC_PLAY_PAUSE, KC_EVENT_KEY_PRESSED);
-                break;
-
             case MSG_BT_BROADCAST:
                 /** @removed: BT broadcast */
 
-                TimeoutSet(&tmrBroadcastPreventFault, 500);
-                break;
-
-            case MSG_PRE:
-                fs_comm_send_command(KC_SKIP_PREVIOUS, KC_EVENT_KEY_PRESSED);
-                break;
-
-            case MSG_NEXT:
-                fs_comm_send_command(KC_SKIP_NEXT, KC_EVENT_KEY_PRESSED);
+                timer_wheel_start(&tmrBroadcastPreventFault, 500, 0, NULL, NULL);
                 break;
 
             case MSG_SPEAKER_MODE:
@@ -351,21 +333,6 @@ static void task_common(EventContext *ev)
                 */
                 break;
 #endif
-            /** factory reset event id */
-            case MSG_FACTORY_RESET:
-                /** ignore if any re trigger from factory reset */
-                // if (system_config.venicex_state == VENICEX_STATE_FACTORY_START)
-                //     return;
-
-                // ignore if there are any factory reset retrigger
-                if ( (/*GET_FLAG( FLAG_FS_FACTORY_RESET_START ) && */!IsTimeout(&tmrFactoryTimeout)) 
-                     || system_config.current_function == SYS_MODE_FACTORY_RESET ) 
-                    return;
-
-                SET_FLAG( FLAG_FS_FACTORY_RESET_START );
-                fs_comm_send_command(KC_FACTORY_RESET, KC_EVENT_KEY_PRESSED);
-                TimeoutSet(&tmrFactoryTimeout, 5000);
-                break;
 
             default: break;
         }
@@ -375,7 +342,138 @@ static void task_common(EventContext *ev)
     /** @removed: nvm  saving */
 
     subtask_bt_broadcast(&system_config);
+}
+
+/**
+ * @brief   key taken only by task accepting it (task with task_common())
+ *          booting: factory reset only while venice x not ready
+ *          idle, factory: none, standby: MSG_POWER only (see. task_standby())
+ * @return  1: key dropped
+*/
+static uint8_t task_key_dropped(const EventContext *ev)
+{
+    switch(ev->eventId)
+    {
+        case MSG_VOL_UP:
+        case MSG_VOL_DW:
+        case MSG_PLAY_PAUSE:
+        case MSG_PRE:
+        case MSG_NEXT:
+            break;
+
+        case MSG_FACTORY_RESET:
+            /** factory reset timeout always handled */
+            if (ev->source == EVENT_SRC_TIMER)
+                return 0;
+            break;
+
+        default:
+            return 0;
+    }
+
+    switch(system_config.current_function)
+    {
+        case SYS_MODE_BOOTING:
+            return ( system_config.venicex_state != VENICEX_STATE_READY &&
+                     ev->eventId != MSG_FACTORY_RESET );
+
+        case SYS_MODE_BT_A2DP:
+        case SYS_MODE_SPOTIFY_CONNECT:
+        case SYS_MODE_NETWORK_CONFIG:
+            return 0;
+
+        default:
+            return 1;
+    }
+}
+
+/**
+ * @brief   key command, run before task handler, key queued to venice x
+ *          scheduler, see. fs_comm_send_command()
+ *          key not accepted by current task dropped, see. task_key_dropped()
+ *          venice x mode kept pending, see. FLAG_FS_MODE_PENDING
+ *          factory reset monitor also run here
+ * @return  1: event consumed, task get MSG_NONE
+ *          0: event left to task
+*/
+static uint8_t task_key_command(EventContext *ev)
+{
+    uint8_t ret = 1;
+
+    if ( task_key_dropped(ev) )
+    {
+        ev->eventId = MSG_NONE;
+    }
+
+    switch(ev->eventId)
+    {
+        /** volume up event id */
+        case MSG_VOL_UP:
+            if (system_config.system_volume < SYS_VOL_MAX)
+            {
+                system_config.system_volume++;
+            }
+
+            timer_wheel_start(&tmrVolumeSync, TIMEOUT_VOLUME_TRICK, 0, NULL, NULL);
+            fs_comm_send_command(KC_VOLUME_UP, KC_EVENT_KEY_PRESSED);
+            break;
+
+        /** volume down event id */
+        case MSG_VOL_DW:
+            if (system_config.system_volume > 0)
+            {
+                system_config.system_volume--;
+            }
+
+            timer_wheel_start(&tmrVolumeSync, TIMEOUT_VOLUME_TRICK, 0, NULL, NULL);
+            fs_comm_send_command(KC_VOLUME_DOWN, KC_EVENT_KEY_PRESSED);
+
+            /** @removed: bt broadcast */
+            break;
+
+        case MSG_PLAY_PAUSE:
+            fs_comm_send_command(KC_PLAY_PAUSE, KC_EVENT_KEY_PRESSED);
+            break;
+
+        case MSG_PRE:
+            fs_comm_send_command(KC_SKIP_PREVIOUS, KC_EVENT_KEY_PRESSED);
+            break;
+
+        case MSG_NEXT:
+            fs_comm_send_command(KC_SKIP_NEXT, KC_EVENT_KEY_PRESSED);
+            break;
+
+        /** factory reset event id */
+        case MSG_FACTORY_RESET:
+            /** venice x not started factory reset on time, allow new press */
+            if (ev->source == EVENT_SRC_TIMER)
+            {
+                CLR_FLAG( FLAG_FS_FACTORY_RESET_START );
+                break;
+            }
+
+            // ignore if there are any factory reset retrigger
+            if ( timer_wheel_is_running(&evFactoryTimeout.timer) || 
+                 system_config.current_function == SYS_MODE_FACTORY_RESET )
+                break;
+
+            SET_FLAG( FLAG_FS_FACTORY_RESET_START );
+            fs_comm_send_command(KC_FACTORY_RESET, KC_EVENT_KEY_PRESSED);
+            event_queue_post_on_timer(&evFactoryTimeout, &app_event_queue, EVQ_PRIO_LOW,
+                                      &msgFactoryTimeout, TIMEOUT_FACTORY_START, 0);
+            break;
 
+        /** venice x mode, applied by do_change_task() when task can
+         * change function (not on booting, standby, factory)
+         */
+        case MSG_SET_MODE:
+            SET_FLAG( FLAG_FS_MODE_PENDING );
+            break;
+
+        default:
+            ret = 0;
+            break;
+    }
 
     if ( GET_FLAG( FLAG_FS_FACTORY_RESET_START ) )
     {
@@ -385,31 +483,14 @@ static void task_common(EventContext *ev)
             system_config.venicex_state = VENICEX_STATE_FACTORY_START;
             /** clear flag , this will be one execute */
             CLR_FLAG( FLAG_FS_FACTORY_RESET_START );
+            timer_wheel_stop(&evFactoryTimeout.timer);
             // goto factory reset task 
             mainTaskState = TASK_STATE_STOP;
             system_config.current_function = SYS_MODE_FACTORY_RESET;
         }
     }
 
-
-    /** just test for i2c polling data */
-    /** wait here */
-    if (IsTimeout(&tmrUpdateI2CReg))
-    {
-        TimeoutSet(&tmrUpdateI2CReg, 100);
-        if ( !FLAG_COUNT_DIRECTION ) {
-            counter = (counter + 1);
-            if (counter == 30) FLAG_COUNT_DIRECTION = 1;
-        }
-        else
-        {
-            counter = (counter - 1);
-            if (counter == 0) FLAG_COUNT_DIRECTION = 0;
-        }
-        /** just to set counter */
-        read_reg->aux1 = (uint8_t) counter;
-    }
-
+    return ret;
 }
 
 void task_network_configuration(void *arg)
@@ -539,12 +620,12 @@ void task_idle(void *arg)
 
         case TASK_STATE_INIT:
             mainTaskState = TASK_STATE_RUN;
-            TimeoutSet(&tmrIdle, 1000);
+            timer_wheel_start(&tmrIdle, 1000, 0, main_task_timer_wake, NULL);
             /** @removed: indicator */
             break;
 
         case TASK_STATE_RUN:
-            if (IsTimeout(&tmrIdle))
+            if ( !timer_wheel_is_running(&tmrIdle) )
             {
                 mainTaskState = TASK_STATE_STOP;
                 /** after idle, go to default function */
@@ -742,7 +823,7 @@ static void task_booting(void *arg)
             if (system_config.venicex_state == VENICEX_STATE_READY)
             {
                 mainTaskState = TASK_STATE_STOP;
-                TimeoutSet(&tmrWaitForWakeup, 2000);
+                timer_wheel_start(&tmrWaitForWakeup, 2000, 0, main_task_timer_wake, NULL);
 
                 read_reg->boot_info.bit.ready = 1;
             }           
@@ -753,7 +834,7 @@ static void task_booting(void *arg)
             break;
 
         case TASK_STATE_STOP:
-            if ( !IsTimeout(&tmrWaitForWakeup) )
+            if ( timer_wheel_is_running(&tmrWaitForWakeup) )
                 return;
 
             /** do deinit task */
@@ -816,7 +897,7 @@ void task_bluetooth_a2dp(void *arg)
 
         case TASK_STATE_INIT:
 #if (CONFIG_ROLLING_MODE)
-            if ( IsTimeout(&tmrWaitChangeMode) )
+            if ( !timer_wheel_is_running(&tmrWaitChangeMode) )
 #else
             if ( 1 )
 #endif
@@ -826,7 +907,7 @@ void task_bluetooth_a2dp(void *arg)
                 {
                     fs_comm_send_command(KC_BLUETOOTH_MODE, KC_EVENT_KEY_PRESSED);
 #if (CONFIG_WAIT_CHANGE_MODE_VENICEX)
-                    TimeoutSet(&tmrBlockingFunctionReplyVx, TIMEOUT_BLOCKING_FUNCTION_REPLY);
+                    timer_wheel_start(&tmrBlockingFunctionReplyVx, TIMEOUT_BLOCKING_FUNCTION_REPLY, 0, main_task_timer_wake, NULL);
 #endif
                 }
                 mainTaskState = TASK_STATE_RUN;
@@ -913,7 +994,7 @@ void task_spotify_connect(void *arg)
                 set_visual_mode(LED_EVENT_STATIC_COLOR);
                 #endif
 #if (CONFIG_ROLLING_MODE)
-                if ( IsTimeout(&tmrWaitChangeMode) )
+                if ( !timer_wheel_is_running(&tmrWaitChangeMode) )
 #else
                 if ( 1 )
 #endif
@@ -925,7 +1006,7 @@ void task_spotify_connect(void *arg)
                     {
                         fs_comm_send_command(KC_SPOTIFY_MODE, KC_EVENT_KEY_PRESSED);
 #if (CONFIG_WAIT_CHANGE_MODE_VENICEX)
-                        TimeoutSet(&tmrBlockingFunctionReplyVx, TIMEOUT_BLOCKING_FUNCTION_REPLY);
+                        timer_wheel_start(&tmrBlockingFunctionReplyVx, TIMEOUT_BLOCKING_FUNCTION_REPLY, 0, main_task_timer_wake, NULL);
 #endif
                     }
                     mainTaskState = TASK_STATE_RUN;
@@ -936,12 +1017,13 @@ void task_spotify_connect(void *arg)
         case TASK_STATE_RUN:
             if (fs_comm_get_wifi_status() == FS_WIFI_STATE_CONNECTED)
             {
-                TimeoutSet(&tmrWaitConn, TIMEOUT_SIMULASI_WIFI_CONN);
+                /** restarted while connected, expire 2 s after disconnect */
+                timer_wheel_start(&tmrWaitConn, TIMEOUT_SIMULASI_WIFI_CONN, 0, main_task_timer_wake, NULL);
             }
             else /** disconnect or setup mode */
             {
                 /** check timeout for 2 S */
-                if (IsTimeout(&tmrWaitConn))
+                if ( !timer_wheel_is_running(&tmrWaitConn) )
                 {
                     system_config.current_function = SYS_MODE_NETWORK_CONFIG;
                     mainTaskState = TASK_STATE_STOP;    /* exit */
@@ -980,11 +1062,117 @@ void (*MainTaskRunState[SYS_MODE_NUM])(void *arg) = {
 /**********************************************************/
 
 
+/**
+ * @brief   just test for i2c polling data, periodic 100 ms
+*/
+static void update_i2c_counter(TW_Timer_t *timer, void *arg)
+{
+    if ( !FLAG_COUNT_DIRECTION ) {
+        counter = (counter + 1);
+        if (counter == 30) FLAG_COUNT_DIRECTION = 1;
+    }
+    else
+    {
+        counter = (counter - 1);
+        if (counter == 0) FLAG_COUNT_DIRECTION = 0;
+    }
+    /** just to set counter */
+    read_reg->aux1 = (uint8_t) counter;
+}
+
+/**
+ * @brief   venice x uart, key command scheduler and status polling
+*/
+static void run_communication(void *arg)
+{
+    communication_fs_handler(&app_event_queue);
+}
+
+/**
+ * @brief   deferred register write, diagnostic and register publish
+*/
+static void run_i2c(void *arg)
+{
+    i2c_comm_handler();
+}
+
+/**
+ * @brief   task period by function, standby run relaxed period
+*/
+static void main_task_power_profile(uint8_t function)
+{
+    if (function == SYS_MODE_STANDBY)
+    {
+        scheduler_set_period(&schTaskComm, SCH_PERIOD_COMM_STANDBY);
+        scheduler_set_period(&schTaskI2c, SCH_PERIOD_I2C_STANDBY);
+        scheduler_set_period(&schTaskApp, SCH_PERIOD_APP_STANDBY);
+        scheduler_set_period(&schTaskLed, SCH_PERIOD_LED_STANDBY);
+    }
+    else
+    {
+        scheduler_set_period(&schTaskComm, SCH_PERIOD_COMM);
+        scheduler_set_period(&schTaskI2c, SCH_PERIOD_I2C);
+        scheduler_set_period(&schTaskApp, SCH_PERIOD_APP);
+        scheduler_set_period(&schTaskLed, SCH_PERIOD_LED);
+    }
+}
+
+/**
+ * @brief   one event per run, highest priority first, key command first
+ *          then running state
+*/
+static void run_application(void *arg)
+{
+    static uint8_t pre_function = SYS_MODE_NUM;
+
+    if ( !event_queue_get(&app_event_queue, &msgSend) )
+    {
+        msgSend.eventId = MSG_NONE;
+    }
+
+    if ( task_key_command(&msgSend) )
+    {
+        msgSend.eventId = MSG_NONE;
+    }
+
+    /** running state **/
+    (*MainTaskRunState[system_config.current_function])((void*)&msgSend);
+
+    if (pre_function != system_config.current_function)
+    {
+        pre_function = system_config.current_function;
+        main_task_power_profile(pre_function);
+    }
+
+    /** event left, run again before next period */
+    if ( event_queue_count(&app_event_queue) )
+    {
+        scheduler_signal(&schTaskApp);
+    }
+
+    /** publish register updated by task */
+    scheduler_signal(&schTaskI2c);
+}
+
+static void run_led_animation(void *arg)
+{
+    led_animation_handler();
+}
+
 /**
  * @brief init main task 
 */
 void main_task_init(void)
 {
+    /** timer wheel, before any module start timer */
+    timer_wheel_init();
+    scheduler_init();
+    low_power_init();
+#if (CONFIG_LOW_POWER_TICKLESS)
+    low_power_set_tickless(1);
+#endif
+    event_queue_init(&app_event_queue);
+
     /** WS2812 led indicator */
     led_animation_init();
 
@@ -993,19 +1181,25 @@ void main_task_init(void)
 
     system_app_init();
 
+    timer_wheel_start(&tmrUpdateI2CReg, 100, 100, update_i2c_counter, NULL);
+
+    /** uart first, slow ws2812_show never delay frame parsing */
+    scheduler_add(&schTaskComm, run_communication, NULL, SCH_PRIO_HIGH, SCH_PERIOD_COMM, SCH_DEADLINE_COMM);
+    scheduler_add(&schTaskI2c, run_i2c, NULL, SCH_PRIO_NORMAL, SCH_PERIOD_I2C, SCH_DEADLINE_I2C);
+    scheduler_add(&schTaskApp, run_application, NULL, SCH_PRIO_NORMAL, SCH_PERIOD_APP, SCH_DEADLINE_APP);
+    scheduler_add(&schTaskLed, run_led_animation, NULL, SCH_PRIO_LOW, SCH_PERIOD_LED, SCH_DEADLINE_LED);
+
+    event_queue_attach(&app_event_queue, &schTaskApp);
+    i2c_comm_attach_task(&schTaskI2c);
+    fs_comm_attach_task(&schTaskComm);
 }
 
+/**
+ * @brief   run one ready task, sleep until next deadline or wake-up
+ *          interrupt when nothing ready
+ *          call at main loop
+*/
 void main_task_run(void *arg)
 {
-    
-    /** handle communication for wifi and bluetooth module */
-    communication_fs_handler(&msgSend);
-
-    /** handler led animation */
-    led_animation_handler();
-
-    /** running state **/
-    (*MainTaskRunState[system_config.current_function])((void*)&msgSend);
+    scheduler_run();
 }
-
-
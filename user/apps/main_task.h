@@ -4,6 +4,9 @@
 #include "main.h"
 #include "app_config.h"
 #include "utility/timeout.h"
+#include "utility/timer_wheel.h"
+#include "utility/scheduler.h"
+#include "utility/low_power.h"
 #include "app_event_message.h"
 #include "sys_app.h"
 #include "communication_iface.h"
@@ -55,6 +58,28 @@
 
 #define VOLUME_AUTO_RECOVER_VALUE_SUB   2
 
+/** scheduler task period and deadline (ms), see. main_task_init()
+ * task also released by event (uart, i2c write, application event)
+ * LED task shorter than TimeUpdate_LED, Draw_Anim keep its own frame time
+*/
+#define SCH_PERIOD_COMM                 1
+#define SCH_DEADLINE_COMM               2
+#define SCH_PERIOD_I2C                  10
+#define SCH_DEADLINE_I2C                5
+#define SCH_PERIOD_APP                  10
+#define SCH_DEADLINE_APP                20
+#define SCH_PERIOD_LED                  5
+#define SCH_DEADLINE_LED                20
+
+/** standby period (ms), task run mostly on event so core sleep longer
+ * between deadline (see. low_power_idle()), I2C read served from
+ * interrupt and not affected
+*/
+#define SCH_PERIOD_COMM_STANDBY         100
+#define SCH_PERIOD_I2C_STANDBY          50
+#define SCH_PERIOD_APP_STANDBY          50
+#define SCH_PERIOD_LED_STANDBY          20      // TimeUpdate_LED
+
 /** prototype function */
 void main_task_init(void);
 void main_task_run(void *arg);
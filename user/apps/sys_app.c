@@ -8,6 +8,9 @@
 /** set global flag */
 gFlag_t gflag_sys;
 
+/** application event, posted by communication and timer, run by task */
+EVQ_Context_t app_event_queue;
+
 /**
  * global system information 
 */
@@ -1,11 +1,19 @@
 #ifndef SYS_APP_H
 #define SYS_APP_H
 
+#include "utility/event_queue.h"
 
-typedef struct
+/** event delivered to task handler, see. app_event_queue */
+typedef EVQ_Event_t EventContext;
+
+/** event source, see. EventContext.source */
+enum
 {
-	uint16_t		eventId;
-}EventContext;
+    EVENT_SRC_LOCAL = 0,
+    EVENT_SRC_I2C,              // key command from i2c master
+    EVENT_SRC_FS,               // venice x status
+    EVENT_SRC_TIMER,
+};
 
 
 enum
@@ -181,6 +189,7 @@ typedef union
 /** extern variable */
 extern SystemConfig_t system_config;
 extern gFlag_t gflag_sys;
+extern EVQ_Context_t app_event_queue;
 /** end of extern variable */
 
 /** flag for saving to nvm */
@@ -242,6 +251,12 @@ extern gFlag_t gflag_sys;
 
 #define FLAG_COUNT_DIRECTION            gflag_sys.bit10
 
+/**
+ * flag to determine function change from venice x not yet applied
+ * (blocked or task not able to change), applied on next do_change_task()
+*/
+#define FLAG_FS_MODE_PENDING            gflag_sys.bit11
+
 #define	GET_FLAG(x)		(x)
 #define	SET_FLAG(x)		(x = 1)
 #define	CLR_FLAG(x)		(x = 0)
@@ -8,26 +8,207 @@
  * @copyright Copyright (c) 2024
  *
  */
+#include <string.h>
 #include "i2c_slave.h"
+#include "utility/cycle_counter.h"
 
 I2C_Slave_t i2c_slave;
-I2C_Data_t *i2c_data;
+static I2C_Data_t i2c_data;
 
-/** this pointer must be point to received buffer in upper layer */
+/** this pointer point to buffer in upper layer, first byte is 
+ * start register, latched on every master read (see. I2C_ReadCallback_t) 
+ */
 static uint8_t *pRegister;
+static uint8_t read_len;
+static uint8_t register_len;
+static const I2C_ReadCallback_t *read_callback;
+
+#if (I2C_SLAVE_USE_DMA)
+DMA_HandleTypeDef hdma_i2c1_rx;
+DMA_HandleTypeDef hdma_i2c1_tx;
+#endif
+
+/** I2C handle, linked on msp init, used by bus monitor */
+static I2C_HandleTypeDef *i2c_handle;
+static uint32_t monitor_irq_total;
+static uint32_t monitor_tick;
+
+/** value sent when master read beyond register map */
+static uint8_t dummy_byte = 0xFF;
 
 /**
  * @brief   I2C Slave init
  * @param   cb      function callback to process received data from master I2C
- * @param   *pReg   array buffer to store data that receive from master
+ * @param   read_cb callback to get register buffer for master read
+ * @param   reg_len length of register buffer, master read is limited to this length
  * 
  * @return  none
  */
-void i2c_slave_init(process_callback cb, uint8_t *pReg)
+void i2c_slave_init(process_callback cb, const I2C_ReadCallback_t *read_cb, uint8_t reg_len)
 {
     i2c_slave.process_callback = cb;
-    i2c_data = (I2C_Data_t*) i2c_slave.rx_data;
-    pRegister = pReg;
+    read_callback = read_cb;
+    register_len = reg_len;
+    i2c_slave.stretch_budget = I2C_SLAVE_STRETCH_BUDGET_US * (SystemCoreClock / 1000000);
+}
+
+/**
+ * @brief   I2C slave low level init, DMA channel for I2C1
+ *          I2C1_RX: DMA1 channel 7
+ *          I2C1_TX: DMA1 channel 6
+ * @note    called on HAL_I2C_MspInit() function on file stm32f1xx_hal_msp.c
+ *          so DMA still linked after re-init on bus error
+ */
+void i2c_slave_msp_init(I2C_HandleTypeDef *hi2c)
+{
+    i2c_handle = hi2c;
+
+#if (I2C_SLAVE_USE_DMA)
+    __HAL_RCC_DMA1_CLK_ENABLE();
+
+    hdma_i2c1_rx.Instance = DMA1_Channel7;
+    hdma_i2c1_rx.Init.Direction = DMA_PERIPH_TO_MEMORY;
+    hdma_i2c1_rx.Init.PeriphInc = DMA_PINC_DISABLE;
+    hdma_i2c1_rx.Init.MemInc = DMA_MINC_ENABLE;
+    hdma_i2c1_rx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+    hdma_i2c1_rx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+    hdma_i2c1_rx.Init.Mode = DMA_NORMAL;
+    hdma_i2c1_rx.Init.Priority = DMA_PRIORITY_HIGH;
+    if (HAL_DMA_Init(&hdma_i2c1_rx) != HAL_OK)
+    {
+        Error_Handler();
+    }
+    __HAL_LINKDMA(hi2c, hdmarx, hdma_i2c1_rx);
+
+    hdma_i2c1_tx.Instance = DMA1_Channel6;
+    hdma_i2c1_tx.Init.Direction = DMA_MEMORY_TO_PERIPH;
+    hdma_i2c1_tx.Init.PeriphInc = DMA_PINC_DISABLE;
+    hdma_i2c1_tx.Init.MemInc = DMA_MINC_ENABLE;
+    hdma_i2c1_tx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+    hdma_i2c1_tx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+    hdma_i2c1_tx.Init.Mode = DMA_NORMAL;
+    hdma_i2c1_tx.Init.Priority = DMA_PRIORITY_HIGH;
+    if (HAL_DMA_Init(&hdma_i2c1_tx) != HAL_OK)
+    {
+        Error_Handler();
+    }
+    __HAL_LINKDMA(hi2c, hdmatx, hdma_i2c1_tx);
+
+    HAL_NVIC_SetPriority(DMA1_Channel6_IRQn, 0, 0);
+    HAL_NVIC_EnableIRQ(DMA1_Channel6_IRQn);
+    HAL_NVIC_SetPriority(DMA1_Channel7_IRQn, 0, 0);
+    HAL_NVIC_EnableIRQ(DMA1_Channel7_IRQn);
+#endif
+}
+
+/**
+ * @brief   I2C slave low level deinit
+ * @note    called on HAL_I2C_MspDeInit() function on file stm32f1xx_hal_msp.c
+ */
+void i2c_slave_msp_deinit(I2C_HandleTypeDef *hi2c)
+{
+#if (I2C_SLAVE_USE_DMA)
+    HAL_DMA_DeInit(hi2c->hdmarx);
+    HAL_DMA_DeInit(hi2c->hdmatx);
+    HAL_NVIC_DisableIRQ(DMA1_Channel6_IRQn);
+    HAL_NVIC_DisableIRQ(DMA1_Channel7_IRQn);
+#endif
+}
+
+/**
+ * @brief   count interrupt for current transaction, start execution time
+ * @note    called on entry of I2C1 event, error and DMA interrupt handler 
+ *          on file stm32f1xx_it.c
+ */
+void i2c_slave_irq_enter(void)
+{
+    i2c_slave.irq_total++;
+    i2c_slave.irq_count++;
+    i2c_slave.isr_start = cycle_counter_get();
+}
+
+/**
+ * @brief   update worst interrupt execution time and stretch budget overrun
+ *          SCL is stretched while event interrupt is pending and served
+ * @note    called on exit of I2C1 event, error and DMA interrupt handler
+ */
+void i2c_slave_irq_exit(void)
+{
+    uint32_t cycles = cycle_counter_get() - i2c_slave.isr_start;
+
+    if (cycles > i2c_slave.isr_cycles_max)
+    {
+        i2c_slave.isr_cycles_max = cycles;
+    }
+
+    if (cycles > i2c_slave.stretch_budget)
+    {
+        i2c_slave.stretch_overrun++;
+    }
+}
+
+#if (I2C_SLAVE_USE_DMA)
+/**
+ * @brief   DMA1 channel 7 (I2C1_RX) interrupt handler
+ */
+void i2c_slave_dma_rx_irq_handler(void)
+{
+    i2c_slave_irq_enter();
+    HAL_DMA_IRQHandler(&hdma_i2c1_rx);
+    i2c_slave_irq_exit();
+}
+
+/**
+ * @brief   DMA1 channel 6 (I2C1_TX) interrupt handler
+ */
+void i2c_slave_dma_tx_irq_handler(void)
+{
+    i2c_slave_irq_enter();
+    HAL_DMA_IRQHandler(&hdma_i2c1_tx);
+    i2c_slave_irq_exit();
+}
+#endif
+
+/**
+ * @brief   update number of byte received by DMA
+ *          DMA counter still hold remaining data after transfer aborted on STOP
+ */
+static void i2c_slave_update_rx_count(I2C_HandleTypeDef *hi2c)
+{
+#if (I2C_SLAVE_USE_DMA)
+    i2c_slave.rx_count = RX_SIZE - __HAL_DMA_GET_COUNTER(hi2c->hdmarx);
+#endif
+}
+
+/**
+ * @brief   pass received burst to upper layer
+ *          rx_data[0] is register, rest of data is written from that register
+ *          with auto increment. write with register only (no data) just set
+ *          register pointer for next read
+ */
+static void i2c_slave_dispatch(void)
+{
+    if (i2c_slave.rx_count > 1)
+    {
+        i2c_data.reg = i2c_slave.rx_data[0];
+        i2c_data.len = i2c_slave.rx_count - 1;
+        i2c_data.data = &i2c_slave.rx_data[1];
+        i2c_slave.process_callback(&i2c_data);
+    }
+    i2c_slave.bytes_received = i2c_slave.rx_count;
+    i2c_slave.rx_count = 0;
+}
+
+/**
+ * @brief   inform upper layer master read is done
+ */
+static void i2c_slave_read_end(void)
+{
+    if (i2c_slave.direction == I2C_SLAVE_DIR_TX)
+    {
+        read_callback->end(i2c_slave.start_position, i2c_slave.bytes_transmitted);
+        i2c_slave.direction = I2C_SLAVE_DIR_NONE;
+    }
 }
 
 /**
@@ -37,6 +218,8 @@ void i2c_slave_init(process_callback cb, uint8_t *pReg)
  */
 void HAL_I2C_ListenCpltCallback(I2C_HandleTypeDef *hi2c)
 {
+    i2c_slave_read_end();
+    i2c_slave.direction = I2C_SLAVE_DIR_NONE;
     HAL_I2C_EnableListen_IT(hi2c);
 }
 
@@ -49,34 +232,85 @@ void HAL_I2C_ListenCpltCallback(I2C_HandleTypeDef *hi2c)
  */
 void HAL_I2C_AddrCallback(I2C_HandleTypeDef *hi2c, uint8_t TransferDirection, uint16_t AddrMatchCode)
 {
+    /** close statistic of previous transaction, 
+     * this ADDR interrupt already counted for new transaction 
+     */
+    i2c_slave.irq_per_xfer = i2c_slave.irq_count - 1;
+    if (i2c_slave.irq_per_xfer > i2c_slave.irq_per_xfer_max)
+    {
+        i2c_slave.irq_per_xfer_max = i2c_slave.irq_per_xfer;
+    }
+    i2c_slave.irq_count = 1;
+    i2c_slave.address = (uint8_t) AddrMatchCode;
+
+    /** previous read not closed */
+    i2c_slave_read_end();
+
     /** transmit direction, from master to slave  */
     if (TransferDirection == I2C_DIRECTION_TRANSMIT)
     {
+        i2c_slave.direction = I2C_SLAVE_DIR_RX;
         i2c_slave.rx_data[0] = 0;       // reset buffer receiver
         i2c_slave.rx_count = 0;
+#if (I2C_SLAVE_USE_DMA)
+        /** receive whole burst, transfer end on STOP (see. HAL_I2C_ErrorCallback) */
+        HAL_I2C_Slave_Seq_Receive_DMA(hi2c,
+                                        i2c_slave.rx_data,
+                                        RX_SIZE,
+                                        I2C_FIRST_AND_LAST_FRAME);
+#else
         HAL_I2C_Slave_Sequential_Receive_IT(hi2c,
         									i2c_slave.rx_data+i2c_slave.rx_count,
 											1,
 											I2C_FIRST_FRAME);
+#endif
     }
     else /* I2C_DIRECTION_RECEIVE receive direction, from slave to master  */
     {
+        /** repeated start after burst write */
+        if (i2c_slave.direction == I2C_SLAVE_DIR_RX)
+        {
+            i2c_slave_update_rx_count(hi2c);
+            i2c_slave_dispatch();
+        }
+        i2c_slave.direction = I2C_SLAVE_DIR_TX;
         i2c_slave.tx_count = 0;
+        i2c_slave.bytes_transmitted = 0;
         i2c_slave.start_position = i2c_slave.rx_data[0];
         i2c_slave.rx_data[0] = 0;
+
+        /** read start outside register map */
+        if (i2c_slave.start_position >= register_len)
+        {
+            i2c_slave.start_position = 0;
+        }
+
+        /** whole transaction served from one register buffer */
+        pRegister = read_callback->begin(i2c_slave.start_position, &read_len);
+#if (I2C_SLAVE_USE_DMA)
+        /** stream rest of buffer, master NACK end the transfer */
+        HAL_I2C_Slave_Seq_Transmit_DMA(hi2c,
+                                        pRegister,
+                                        read_len,
+                                        I2C_FIRST_AND_LAST_FRAME);
+#else
         HAL_I2C_Slave_Seq_Transmit_IT(hi2c, 
-                                        pRegister + i2c_slave.start_position + i2c_slave.tx_count,
+                                        pRegister + i2c_slave.tx_count,
                                         2,                  /** len of data receive */
                                         I2C_FIRST_FRAME     /** just for first frame after i2c start */
                                     );
+#endif
     }
 }
 
 /**
  * @brief completed callback 
- *          write format:
- *          [I2C Address]   ->  [register]  ->  [   data    ]
- *          |    byte   |       |  byte  |      |    Word   |
+ *          write format (burst, register auto increment):
+ *          [I2C Address]   ->  [register]  ->  [data 0] -> [data 1] ... [data n]
+ *          |    byte   |       |  byte  |      | reg+0 |    | reg+1 |    | reg+n |
+ *
+ *          each byte is acked till RX_SIZE, end of burst detected on STOP
+ *          (see. HAL_I2C_ErrorCallback AF) or when buffer is full
  * 
  *          read format
  *          []
@@ -84,7 +318,14 @@ void HAL_I2C_AddrCallback(I2C_HandleTypeDef *hi2c, uint8_t TransferDirection, ui
  */
 void HAL_I2C_SlaveRxCpltCallback(I2C_HandleTypeDef *hi2c)
 {
-
+#if (I2C_SLAVE_USE_DMA)
+    /** DMA buffer full, rest of burst ignored, burst consumed so
+     * following STOP or repeated start not dispatch it again
+     */
+    i2c_slave.rx_count = RX_SIZE;
+    i2c_slave_dispatch();
+    i2c_slave.direction = I2C_SLAVE_DIR_NONE;
+#else
     i2c_slave.rx_count += 1;
 	if (i2c_slave.rx_count < RX_SIZE)
 	{
@@ -106,11 +347,13 @@ void HAL_I2C_SlaveRxCpltCallback(I2C_HandleTypeDef *hi2c)
 		}
 	}
 
-    /** process data if count fullfiled */
+    /** process data if buffer full, rest of burst will be NACK */
 	if (i2c_slave.rx_count == RX_SIZE)
 	{
-		i2c_slave.process_callback(i2c_data);
+		i2c_slave_dispatch();
+		i2c_slave.direction = I2C_SLAVE_DIR_NONE;
 	}
+#endif
 }
 
 void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c)
@@ -118,17 +361,21 @@ void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c)
     i2c_slave.errcode = HAL_I2C_GetError(hi2c);
     if (i2c_slave.errcode == 0x04) // AF error
     {
-        if (i2c_slave.tx_count == 0) // error is while slave is receiving
+        if (i2c_slave.direction == I2C_SLAVE_DIR_RX) // STOP while slave is receiving, end of burst
         {
-            i2c_slave.bytes_received = i2c_slave.rx_count - 1;
-            i2c_slave.rx_count = 0; 
-            i2c_slave.process_callback(i2c_data);
+            i2c_slave_update_rx_count(hi2c);
+            i2c_slave_dispatch();
         }
-        else // error while slave is transmitting
+        else if (i2c_slave.direction == I2C_SLAVE_DIR_TX) // error while slave is transmitting
         {
+#if (I2C_SLAVE_USE_DMA)
+            i2c_slave.tx_count = read_len - __HAL_DMA_GET_COUNTER(hi2c->hdmatx);
+#endif
             i2c_slave.bytes_transmitted = i2c_slave.tx_count - 1;   
             i2c_slave.tx_count = 0;     // reset tx count for next operation
+            i2c_slave_read_end();
         }
+        i2c_slave.direction = I2C_SLAVE_DIR_NONE;
     }
     /* BERR Error commonly occurs during the Direction switch
      * Here we the software reset bit is set by the HAL error handler
@@ -141,10 +388,109 @@ void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c)
         HAL_I2C_Init(hi2c);
         memset(i2c_slave.rx_data, '\0', RX_SIZE);
         i2c_slave.rx_count = 0;
+        i2c_slave_read_end();
+        i2c_slave.direction = I2C_SLAVE_DIR_NONE;
+    }
+    HAL_I2C_EnableListen_IT(hi2c);
+}
+
+
+/**
+ * @brief   half SCL period of recovery clock (~100 kHz)
+ */
+static void i2c_slave_bus_delay(void)
+{
+    uint32_t start = cycle_counter_get();
+    uint32_t cycles = 5 * (SystemCoreClock / 1000000);
+
+    while (cycle_counter_get() - start < cycles);
+}
+
+/**
+ * @brief   release stuck bus and re-enter listen mode
+ *          1. deinit I2C, slave stop driving SDA/SCL
+ *          2. clock SCL as gpio (max 9 pulse) till device holding SDA 
+ *             release it, then generate STOP
+ *          3. init I2C (pins back to I2C on msp init) and listen
+ * @note    called from main loop, I2C interrupt disabled on deinit
+ */
+static void i2c_slave_bus_recover(I2C_HandleTypeDef *hi2c)
+{
+    GPIO_InitTypeDef GPIO_InitStruct = {0};
+    uint8_t i;
+
+    HAL_I2C_DeInit(hi2c);
+
+    HAL_GPIO_WritePin(I2C_SLAVE_BUS_PORT, I2C_SLAVE_SCL_PIN | I2C_SLAVE_SDA_PIN, GPIO_PIN_SET);
+    GPIO_InitStruct.Pin = I2C_SLAVE_SCL_PIN | I2C_SLAVE_SDA_PIN;
+    GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_OD;
+    GPIO_InitStruct.Pull = GPIO_NOPULL;
+    GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_HIGH;
+    HAL_GPIO_Init(I2C_SLAVE_BUS_PORT, &GPIO_InitStruct);
+    i2c_slave_bus_delay();
+
+    for (i = 0; i < 9; i++)
+    {
+        if (HAL_GPIO_ReadPin(I2C_SLAVE_BUS_PORT, I2C_SLAVE_SDA_PIN) == GPIO_PIN_SET)
+            break;
+
+        HAL_GPIO_WritePin(I2C_SLAVE_BUS_PORT, I2C_SLAVE_SCL_PIN, GPIO_PIN_RESET);
+        i2c_slave_bus_delay();
+        HAL_GPIO_WritePin(I2C_SLAVE_BUS_PORT, I2C_SLAVE_SCL_PIN, GPIO_PIN_SET);
+        i2c_slave_bus_delay();
     }
+
+    /** STOP, SDA rising while SCL high */
+    HAL_GPIO_WritePin(I2C_SLAVE_BUS_PORT, I2C_SLAVE_SDA_PIN, GPIO_PIN_RESET);
+    i2c_slave_bus_delay();
+    HAL_GPIO_WritePin(I2C_SLAVE_BUS_PORT, I2C_SLAVE_SDA_PIN, GPIO_PIN_SET);
+    i2c_slave_bus_delay();
+
+    HAL_I2C_Init(hi2c);
+
+    memset(i2c_slave.rx_data, '\0', RX_SIZE);
+    i2c_slave.rx_count = 0;
+    i2c_slave_read_end();
+    i2c_slave.direction = I2C_SLAVE_DIR_NONE;
+    i2c_slave.bus_recover_count++;
+
     HAL_I2C_EnableListen_IT(hi2c);
 }
 
+/**
+ * @brief   detect stuck bus (SCL / SDA held low) or stalled transaction
+ *          bus not idle without any I2C interrupt for 
+ *          I2C_SLAVE_STUCK_TIMEOUT_MS is recovered (see. i2c_slave_bus_recover)
+ * @note    call at main loop
+ */
+void i2c_slave_bus_monitor(void)
+{
+    uint8_t cause = 0;
+
+    if (!i2c_handle) return;
+
+    if (HAL_GPIO_ReadPin(I2C_SLAVE_BUS_PORT, I2C_SLAVE_SCL_PIN) == GPIO_PIN_RESET)
+        cause |= I2C_BUS_STUCK_SCL;
+    if (HAL_GPIO_ReadPin(I2C_SLAVE_BUS_PORT, I2C_SLAVE_SDA_PIN) == GPIO_PIN_RESET)
+        cause |= I2C_BUS_STUCK_SDA;
+    if (i2c_slave.direction != I2C_SLAVE_DIR_NONE)
+        cause |= I2C_BUS_STALLED;
+
+    /** bus idle or transaction still progressing */
+    if (cause == 0 || i2c_slave.irq_total != monitor_irq_total)
+    {
+        monitor_irq_total = i2c_slave.irq_total;
+        monitor_tick = HAL_GetTick();
+        return;
+    }
+
+    if (HAL_GetTick() - monitor_tick < I2C_SLAVE_STUCK_TIMEOUT_MS)
+        return;
+
+    i2c_slave.bus_stuck_cause = cause;
+    i2c_slave_bus_recover(i2c_handle);
+    monitor_tick = HAL_GetTick();
+}
 
 /***
  * @brief   i2c slave tx completed callback
@@ -152,9 +498,23 @@ void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c)
  */
 void HAL_I2C_SlaveTxCpltCallback(I2C_HandleTypeDef *hi2c)
 {
+#if (I2C_SLAVE_USE_DMA)
+    /** whole buffer sent, master still reading */
+    i2c_slave.tx_count = read_len;
+    i2c_slave.bytes_transmitted = i2c_slave.tx_count;
+    HAL_I2C_Slave_Seq_Transmit_IT(hi2c, &dummy_byte, 1, I2C_NEXT_FRAME);
+#else
     i2c_slave.tx_count += 1;
+    i2c_slave.bytes_transmitted = i2c_slave.tx_count;
+    if (i2c_slave.tx_count >= read_len)
+    {
+        /** master read beyond buffer */
+        HAL_I2C_Slave_Seq_Transmit_IT(hi2c, &dummy_byte, 1, I2C_NEXT_FRAME);
+        return;
+    }
     HAL_I2C_Slave_Seq_Transmit_IT(hi2c, 
-                                pRegister + i2c_slave.start_position + i2c_slave.tx_count, 
+                                pRegister + i2c_slave.tx_count, 
                                 1, 
                                 I2C_NEXT_FRAME);
+#endif
 }
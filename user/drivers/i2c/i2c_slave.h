@@ -13,15 +13,74 @@
 
 #include <stdint.h>
 #include "main.h"
+#include "app_config.h"
 
-#define RX_SIZE 2
+/** max bytes in one write transaction: [register] + burst data
+ * every byte after the register byte goes to the next register (auto-increment)
+ * sized for LED frame burst: [register] [R G B x CONFIG_LED_NUMBER] [commit] [PEC]
+ */
+#define RX_SIZE 48
+
+/**
+ * I2C slave transfer engine
+ * 1: DMA, whole transaction in one transfer, completed on STOP
+ *    (one interrupt per transaction instead of one per byte)
+ * 0: IT, re-arm sequential transfer every byte (fallback)
+ */
+#define I2C_SLAVE_USE_DMA   (1)
+
+/** bus speed, see. CONFIG_I2C_FAST_MODE */
+#if (CONFIG_I2C_FAST_MODE)
+#define I2C_SLAVE_CLOCK_SPEED   400000
+#else
+#define I2C_SLAVE_CLOCK_SPEED   100000
+#endif
+
+/** max time slave may hold SCL low (interrupt execution), 4 SCL period
+ * 10 us on fast mode, 40 us on standard mode
+ * interrupt longer than this is counted as stretch overrun
+ * worst case DMA path at 72 MHz is ADDR on repeated start (register
+ * pointer, read begin, tx DMA arm), estimated ~610 cycle = 8.5 us against
+ * 720 cycle fast mode budget, not measured on target yet, check with
+ * isr_time_max (diag register 0x14) and stretch_overrun
+ */
+#define I2C_SLAVE_STRETCH_BUDGET_US     (4 * 1000000 / I2C_SLAVE_CLOCK_SPEED)
+
+/** I2C1 bus pins, driven as gpio on bus recovery */
+#define I2C_SLAVE_BUS_PORT      GPIOB
+#define I2C_SLAVE_SCL_PIN       GPIO_PIN_6
+#define I2C_SLAVE_SDA_PIN       GPIO_PIN_7
+
+/** bus considered stuck when not idle and no I2C interrupt for this 
+ * time (SMBus T_TIMEOUT) 
+ */
+#define I2C_SLAVE_STUCK_TIMEOUT_MS  25
+
+/** bus stuck cause, see. i2c_slave_bus_monitor */
+#define I2C_BUS_STUCK_SCL       (1<<0)  /** SCL held low */
+#define I2C_BUS_STUCK_SDA       (1<<1)  /** SDA held low */
+#define I2C_BUS_STALLED         (1<<2)  /** transaction not completed */
 
+#if (CONFIG_I2C_FAST_MODE) && !(I2C_SLAVE_USE_DMA)
+#warning "I2C fast mode with per byte interrupt may exceed stretch budget"
+#endif
 
-/** data mapping struct */
-typedef struct __attribute__((packed))
+enum
+{
+    I2C_SLAVE_DIR_NONE = 0,
+    I2C_SLAVE_DIR_RX,           /** master write, slave receive */
+    I2C_SLAVE_DIR_TX,           /** master read, slave transmit */
+};
+
+/** data mapping struct
+ * reg:  first register of the burst
+ * len:  number of data byte, data[i] goes to register (reg + i)
+ */
+typedef struct
 {
     uint8_t reg;
-    uint16_t data;
+    uint8_t len;
+    uint8_t *data;
 } I2C_Data_t;
 
 typedef
@@ -32,17 +91,59 @@ struct _i2c_slave
     uint8_t tx_count;
     uint8_t rx_count;
     uint8_t start_position;
+    uint8_t direction;
+    uint8_t address;                // matched own address (8 bit, R/W bit cleared)
     uint8_t rx_data[RX_SIZE];
     uint32_t errcode;
     void (*process_callback)(I2C_Data_t *data);
 
+    /** interrupt statistic, counted on every I2C1 event/error/DMA interrupt */
+    uint32_t irq_total;             // interrupt since power on
+    uint32_t irq_count;             // interrupt on current transaction
+    uint32_t irq_per_xfer;          // interrupt on last completed transaction
+    uint32_t irq_per_xfer_max;      // worst transaction since power on
+
+    /** interrupt execution time (core cycle), see. cycle_counter.h */
+    uint32_t isr_start;             // cycle counter on interrupt entry
+    uint32_t isr_cycles_max;        // longest interrupt since power on
+    uint32_t stretch_budget;        // I2C_SLAVE_STRETCH_BUDGET_US in core cycle
+    uint32_t stretch_overrun;       // interrupt exceeded stretch budget
+
+    /** bus recovery statistic */
+    uint32_t bus_recover_count;     // bus recovery since power on
+    uint8_t bus_stuck_cause;        // cause of last recovery, see. I2C_BUS_STUCK_x
+
 } I2C_Slave_t;
 
 
 typedef void (*process_callback)(I2C_Data_t *);
 
+/** master read callback
+ * begin:   called on read start, return buffer sent from register reg for 
+ *          whole transaction, len: number of byte available on buffer
+ * end:     called on read end (master NACK / STOP), count: number of byte sent
+ */
+typedef struct
+{
+    uint8_t *(*begin)(uint8_t reg, uint8_t *len);
+    void (*end)(uint8_t reg, uint8_t count);
+} I2C_ReadCallback_t;
+
 /** prototype function */
-void i2c_slave_init(process_callback cb, uint8_t *pReg);
+void i2c_slave_init(process_callback cb, const I2C_ReadCallback_t *read_cb, uint8_t reg_len);
+void i2c_slave_msp_init(I2C_HandleTypeDef *hi2c);
+void i2c_slave_msp_deinit(I2C_HandleTypeDef *hi2c);
+void i2c_slave_irq_enter(void);
+void i2c_slave_irq_exit(void);
+void i2c_slave_bus_monitor(void);
+#if (I2C_SLAVE_USE_DMA)
+void i2c_slave_dma_rx_irq_handler(void);
+void i2c_slave_dma_tx_irq_handler(void);
+#endif
 /** end of prototype function  */
 
+/** extern resource */
+extern I2C_Slave_t i2c_slave;
+/** end of extern resource */
+
 #endif /** end of I2C_SLAVE_H */
\ No newline at end of file
@@ -9,16 +9,24 @@
  * 
  */
 #include <stdint.h>
+#include <string.h>
 #include "fs_comm.h"
 #include "main.h"
 #include "app_config.h"
+#include "utility/cycle_counter.h"
+#include "utility/crc.h"
+#if (CONFIG_FS_SIMULATOR)
+#include "fs_sim.h"
+#endif
 
 /** uart instance*/
 #define FS_UART     (USART1)
 
-FrontierSilicon_t FS;
+/** uart receive DMA */
+#define FS_DMA              (DMA1)
+#define FS_DMA_RX_CHANNEL   (LL_DMA_CHANNEL_5)
 
-TIMER tmrSysReq;
+FrontierSilicon_t FS;
 
 void fs_comm_init(void)
 {
@@ -26,10 +34,119 @@ void fs_comm_init(void)
     
     /** init circular buffer */
     MCUCircular_Config(&FS.cbCtx, FS.circular_buffer, FS_CIRCULAR_BUFF_LEN);
-
+    MCUCircular_Config(&FS.txCtx, FS.tx_circular_buffer, FS_TX_CIRCULAR_BUFF_LEN);
+    FS.sched.mode_cmd = FS_CMD_NONE;
+    FS.sched.volume_target = -1;
+
+#if (CONFIG_FS_SIMULATOR)
+    /** virtual uart, USART1 left idle */
+    fs_sim_init();
+#elif (FS_UART_USE_DMA)
+    /** DMA write directly to circular buffer, wrap on end of buffer */
+    LL_AHB1_GRP1_EnableClock(LL_AHB1_GRP1_PERIPH_DMA1);
+
+    LL_DMA_ConfigTransfer(FS_DMA, FS_DMA_RX_CHANNEL,
+                            LL_DMA_DIRECTION_PERIPH_TO_MEMORY |
+                            LL_DMA_MODE_CIRCULAR |
+                            LL_DMA_PERIPH_NOINCREMENT |
+                            LL_DMA_MEMORY_INCREMENT |
+                            LL_DMA_PDATAALIGN_BYTE |
+                            LL_DMA_MDATAALIGN_BYTE |
+                            LL_DMA_PRIORITY_MEDIUM);
+    LL_DMA_ConfigAddresses(FS_DMA, FS_DMA_RX_CHANNEL,
+                            LL_USART_DMA_GetRegAddr(FS_UART),
+                            (uint32_t) FS.circular_buffer,
+                            LL_DMA_DIRECTION_PERIPH_TO_MEMORY);
+    LL_DMA_SetDataLength(FS_DMA, FS_DMA_RX_CHANNEL, FS_CIRCULAR_BUFF_LEN);
+
+    /** half / full transfer, keep write index updated on back to back frame */
+    LL_DMA_EnableIT_HT(FS_DMA, FS_DMA_RX_CHANNEL);
+    LL_DMA_EnableIT_TC(FS_DMA, FS_DMA_RX_CHANNEL);
+    NVIC_SetPriority(DMA1_Channel5_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(),0, 0));
+    NVIC_EnableIRQ(DMA1_Channel5_IRQn);
+
+    LL_DMA_EnableChannel(FS_DMA, FS_DMA_RX_CHANNEL);
+    LL_USART_EnableDMAReq_RX(FS_UART);
+    LL_USART_EnableIT_IDLE(FS_UART);
+    /** overrun, framing and noise error interrupt (DMA receive only) */
+    LL_USART_EnableIT_ERROR(FS_UART);
+#else
     LL_USART_EnableIT_RXNE(FS.uart_handler);
+#endif
+
+    /** first status request, then periodic on timer wheel */
+    fs_system_req();
+}
+
+/**
+ * @brief   set task running communication handler, signaled on received
+ *          data and queued key command, so handler not wait next period
+*/
+void fs_comm_attach_task(SCH_Task_t *task)
+{
+    FS.task = task;
+}
+
+/**
+ * @brief   wake task running communication handler
+*/
+static void fs_comm_notify(void)
+{
+    if (FS.task)
+    {
+        scheduler_signal(FS.task);
+    }
 }
 
+#if (FS_UART_USE_DMA)
+/**
+ * @brief   update circular buffer write index from DMA position
+ *          DMA counter count down from FS_CIRCULAR_BUFF_LEN and reloaded on wrap
+ *          DMA never stop on full buffer, unread data overwritten when
+ *          received byte reach read index, detected here and buffer
+ *          flushed on next fs_comm_scan_data()
+ * @note    called at least every half buffer (DMA half / full transfer)
+ */
+static void fs_dma_update_write_index(void)
+{
+    uint32_t pos = (FS_CIRCULAR_BUFF_LEN - LL_DMA_GetDataLength(FS_DMA, FS_DMA_RX_CHANNEL)) & FS.cbCtx.Mask;
+    uint32_t pending = FS.cbCtx.W - FS.cbCtx.R;
+    uint32_t received = (pos - FS.cbCtx.W) & FS.cbCtx.Mask;
+
+    if (pending + received > FS_CIRCULAR_BUFF_LEN)
+    {
+        FS.rx_overflow++;
+        FS.rx_flush = 1;
+    }
+
+    /** write index free running, advanced by byte received since last update */
+    FS.cbCtx.W += received;
+}
+
+/**
+ * @brief   DMA1 channel 5 (USART1_RX) interrupt handler, half / full transfer
+ * 
+ * @note    called on DMA1_Channel5_IRQHandler() function on file stm32f1xx_it.c 
+*/
+void FS_DMA_RX_IRQ_Handler(void)
+{
+    FS.rx_irq_count++;
+
+    if (LL_DMA_IsActiveFlag_HT5(FS_DMA))
+    {
+        LL_DMA_ClearFlag_HT5(FS_DMA);
+    }
+
+    if (LL_DMA_IsActiveFlag_TC5(FS_DMA))
+    {
+        LL_DMA_ClearFlag_TC5(FS_DMA);
+    }
+
+    fs_dma_update_write_index();
+    fs_comm_notify();
+}
+#endif
+
 /**
  * @brief uart2 receive handler
  * 
@@ -37,22 +154,89 @@ void fs_comm_init(void)
 */
 void FS_USART_IRQ_Handler(void)
 {
-	uint8_t temp;
+    MCU_CIRCULAR_SPAN span;
 
-    /** if any data received */
-    if (LL_USART_IsActiveFlag_RXNE(FS.uart_handler))
+    /** receive error, flag cleared by SR read followed by DR read */
+    if (LL_USART_IsActiveFlag_ORE(FS.uart_handler))
+    {
+        FS.rx_overrun++;
+    }
+    if (LL_USART_IsActiveFlag_FE(FS.uart_handler) || LL_USART_IsActiveFlag_NE(FS.uart_handler))
+    {
+        if (LL_USART_IsActiveFlag_FE(FS.uart_handler))
+            FS.rx_frame_error++;
+        if (LL_USART_IsActiveFlag_NE(FS.uart_handler))
+            FS.rx_noise_error++;
+
+#if !(FS_UART_USE_DMA)
+        /** byte on DR is corrupted, drop it, broken frame resync on parser */
+        if (LL_USART_IsActiveFlag_RXNE(FS.uart_handler))
+        {
+            (void) LL_USART_ReceiveData8(FS.uart_handler);
+            FS.rx_discard++;
+        }
+#endif
+    }
+#if (FS_UART_USE_DMA)
+    /** DMA read of DR normally clear the flag, read DR here only when
+     * no byte waiting for DMA, otherwise interrupt keep firing
+     */
+    if ((LL_USART_IsActiveFlag_ORE(FS.uart_handler) ||
+         LL_USART_IsActiveFlag_FE(FS.uart_handler) ||
+         LL_USART_IsActiveFlag_NE(FS.uart_handler)) &&
+        !LL_USART_IsActiveFlag_RXNE(FS.uart_handler))
     {
-    	temp = LL_USART_ReceiveData8(FS.uart_handler);
-        MCUCircular_PutData(&FS.cbCtx, &temp, 1);
+        LL_USART_ClearFlag_ORE(FS.uart_handler);
     }
+#endif
 
-    /** if any error occur */
-    if (LL_USART_IsActiveFlag_ORE(FS.uart_handler))
+#if (FS_UART_USE_DMA)
+    /** line idle after frame, data already on circular buffer */
+    if (LL_USART_IsActiveFlag_IDLE(FS.uart_handler))
+    {
+        FS.rx_irq_count++;
+        LL_USART_ClearFlag_IDLE(FS.uart_handler);
+        fs_dma_update_write_index();
+        fs_comm_notify();
+    }
+#else
+    /** if any data received, also clear overrun (byte before overrun kept) */
+    if (LL_USART_IsActiveFlag_RXNE(FS.uart_handler))
     {
+        FS.rx_irq_count++;
+        /** byte stored in place on ring */
+        if (MCUCircular_Reserve(&FS.cbCtx, &span) > 0)
+        {
+            span.Ptr[0][0] = LL_USART_ReceiveData8(FS.uart_handler);
+            MCUCircular_Commit(&FS.cbCtx, 1);
+        }
+        else
+        {
+            (void) LL_USART_ReceiveData8(FS.uart_handler);
+            FS.rx_overflow++;
+        }
+        fs_comm_notify();
+    }
+#endif
 
+#if (FS_UART_TX_USE_IT)
+    /** transmit register empty, send next byte of tx ring */
+    if (LL_USART_IsEnabledIT_TXE(FS.uart_handler) && LL_USART_IsActiveFlag_TXE(FS.uart_handler))
+    {
+        if (MCUCircular_Peek(&FS.txCtx, &span) > 0)
+        {
+            LL_USART_TransmitData8(FS.uart_handler, span.Ptr[0][0]);
+            MCUCircular_Consume(&FS.txCtx, 1);
+        }
+        else
+        {
+            LL_USART_DisableIT_TXE(FS.uart_handler);
+        }
     }
+#endif
 }
 
+#if !(FS_UART_TX_USE_IT)
 static void fs_uart_send_byte(uint8_t data)
 {
     uint32_t timeout = 10;
@@ -73,14 +257,22 @@ static void fs_uart_send_byte(uint8_t data)
     LL_USART_TransmitData8(FS.uart_handler, data);
 }
 
+#endif
+
 /**
- * The data sent from Polytron MCU to VeniceX module are named key command. 
- * The data length of the key command is limited to 2 bytes.
+ * @brief   send one key command frame
+ * @return  0: frame sent (queued on tx ring)
+ *          -1: tx ring full, frame dropped
 */
-int fs_comm_send_command(uint8_t command, uint8_t data)
+static int fs_comm_send_frame(uint8_t command, uint8_t data)
 {
     uint8_t tx_data[FS_KEY_COMMAND_PACKET_LEN];
+    uint32_t start = cycle_counter_get();
+    uint32_t cycles;
+    int ret = 0;
+#if !(FS_UART_TX_USE_IT)
     uint8_t i = 0;
+#endif
 
     tx_data[0] = FS_HEADER1;
     tx_data[1] = FS_HEADER2;
@@ -89,67 +281,400 @@ int fs_comm_send_command(uint8_t command, uint8_t data)
     tx_data[4] = command;
     tx_data[5] = data;
 
+    /** state change expected, poll status fast */
+    if (command != KC_SYSTEM_STATUS_REQ)
+    {
+        fs_system_req_boost();
+    }
+
+#if (FS_UART_TX_USE_IT)
+    /** whole frame or nothing */
+    if (MCUCircular_GetSpaceLen(&FS.txCtx) >= FS_KEY_COMMAND_PACKET_LEN)
+    {
+        MCUCircular_PutData(&FS.txCtx, tx_data, FS_KEY_COMMAND_PACKET_LEN);
+#if !(CONFIG_FS_SIMULATOR)
+        LL_USART_EnableIT_TXE(FS.uart_handler);
+#endif
+    }
+    else
+    {
+        FS.tx_drop++;
+        ret = -1;
+    }
+#else
     /** send uart data */
     for(i = 0; i < FS_KEY_COMMAND_PACKET_LEN; i += 1)
     {
         fs_uart_send_byte(tx_data[i]);
     }
+#endif
+
+    /** caller blocking time */
+    cycles = cycle_counter_get() - start;
+    if (cycles > FS.tx_block_cycles_max)
+    {
+        FS.tx_block_cycles_max = cycles;
+    }
 
-    return 0; // dummy return
+    return (ret);
 }
 
+/**
+ * @brief   frame gap elapsed, next scheduled key command may be sent
+ *          timer wheel callback
+ */
+static void fs_cmd_gap_timer(TW_Timer_t *timer, void *arg)
+{
+    fs_comm_notify();
+}
+
+/**
+ * @brief   volume settled, follow volume reported by module
+ *          timer wheel callback
+ */
+static void fs_cmd_volume_settle_timer(TW_Timer_t *timer, void *arg)
+{
+    if (!FS.sched.volume_pending)
+    {
+        FS.sched.volume_target = -1;
+    }
+}
+
+/**
+ * @brief   put key command on ordered queue, caller check space
+ */
+static void fs_cmd_enqueue(FS_CmdScheduler_t *s, uint8_t command, uint8_t data)
+{
+    s->queue[s->head % FS_CMD_QUEUE_LEN][0] = command;
+    s->queue[s->head % FS_CMD_QUEUE_LEN][1] = data;
+    s->head++;
+}
+
+/**
+ * The data sent from Polytron MCU to VeniceX module are named key command. 
+ * The data length of the key command is limited to 2 bytes.
+ * 
+ * command passed to scheduler, sent later by fs_comm_scheduler_handler()
+ * 
+ * @return  0: command scheduled
+ *          -1: scheduler queue full, command dropped
+*/
+int fs_comm_send_command(uint8_t command, uint8_t data)
+{
+    FS_CmdScheduler_t *s = &FS.sched;
+    int16_t volume;
+
+    switch (command)
+    {
+        case KC_SYSTEM_STATUS_REQ:
+            if (s->status_req) s->merged++;
+            s->status_req = 1;
+            break;
+
+        case KC_VOLUME_UP:
+        case KC_VOLUME_DOWN:
+        case KC_SET_VOLUME:
+            /** relative step from last target, or from module volume */
+            volume = (s->volume_target >= 0) ? s->volume_target : FS.config.data2.bit.volume;
+
+            if (command == KC_VOLUME_UP)
+                volume++;
+            else if (command == KC_VOLUME_DOWN)
+                volume--;
+            else
+                volume = data;
+
+            if (volume < 0) volume = 0;
+            if (volume > FS_VOLUME_MAX) volume = FS_VOLUME_MAX;
+
+            if (s->volume_pending) s->merged++;
+            s->volume_target = volume;
+            s->volume_pending = 1;
+            break;
+
+        case KC_SPOTIFY_MODE:
+        case KC_BLUETOOTH_MODE:
+            if (s->mode_cmd != FS_CMD_NONE) s->merged++;
+            s->mode_cmd = command;
+            s->mode_data = data;
+            break;
+
+        default:
+            /** ordered command (standby toggle, playback, ...), each press
+             * sent in order, pending mode command moved to queue first so
+             * mode then key never sent as key then mode
+             */
+            if ((uint8_t)(s->head - s->tail) >= FS_CMD_QUEUE_LEN - (s->mode_cmd != FS_CMD_NONE))
+            {
+                FS.tx_drop++;
+                return -1;
+            }
+            if (s->mode_cmd != FS_CMD_NONE)
+            {
+                fs_cmd_enqueue(s, s->mode_cmd, s->mode_data);
+                s->mode_cmd = FS_CMD_NONE;
+            }
+            fs_cmd_enqueue(s, command, data);
+            break;
+    }
+
+    fs_comm_notify();
+
+    return 0;
+}
+
+/**
+ * @brief   send scheduled key command, one frame every FS_CMD_FRAME_GAP
+ *          order: ordered command, mode, volume, system status request
+ *          (mode command given before ordered command already on queue)
+ * 
+ * @note    call at loop
+*/
+void fs_comm_scheduler_handler(void)
+{
+    FS_CmdScheduler_t *s = &FS.sched;
+
+    if (timer_wheel_is_running(&s->gap))
+        return;
+
+#if (FS_UART_TX_USE_IT)
+    if (MCUCircular_GetSpaceLen(&FS.txCtx) < FS_KEY_COMMAND_PACKET_LEN)
+        return;
+#endif
+
+    if (s->head != s->tail)
+    {
+        fs_comm_send_frame(s->queue[s->tail % FS_CMD_QUEUE_LEN][0], 
+                            s->queue[s->tail % FS_CMD_QUEUE_LEN][1]);
+        s->tail++;
+    }
+    else if (s->mode_cmd != FS_CMD_NONE)
+    {
+        fs_comm_send_frame(s->mode_cmd, s->mode_data);
+        s->mode_cmd = FS_CMD_NONE;
+    }
+    else if (s->volume_pending)
+    {
+        fs_comm_send_frame(KC_SET_VOLUME, s->volume_target);
+        s->volume_pending = 0;
+        timer_wheel_start(&s->volume_settle, FS_VOLUME_SETTLE_TIME, 0, fs_cmd_volume_settle_timer, NULL);
+    }
+    else if (s->status_req)
+    {
+        fs_comm_send_frame(KC_SYSTEM_STATUS_REQ, 0x00);
+        s->status_req = 0;
+    }
+    else
+    {
+        return;
+    }
+
+    timer_wheel_start(&s->gap, FS_CMD_FRAME_GAP, 0, fs_cmd_gap_timer, NULL);
+}
+
+
+/**
+ * @brief   received byte at offset from read index, in place, not consumed
+*/
+static uint8_t fs_rx_byte(const MCU_CIRCULAR_SPAN *span, uint16_t offset)
+{
+    return (offset < span->Len[0]) ? span->Ptr[0][offset] : span->Ptr[1][offset - span->Len[0]];
+}
+
+/**
+ * @brief   checksum of received data at offset, in place
+*/
+static uint16_t fs_rx_crc16(const MCU_CIRCULAR_SPAN *span, uint16_t offset, uint16_t len)
+{
+    uint16_t crc = CRC16_INIT;
+    uint16_t first;
+
+    if (offset < span->Len[0])
+    {
+        first = span->Len[0] - offset;
+        if (first > len)
+            first = len;
+        crc = crc16(crc, &span->Ptr[0][offset], first);
+        offset = 0;
+        len -= first;
+    }
+    else
+    {
+        offset -= span->Len[0];
+    }
+
+    return crc16(crc, &span->Ptr[1][offset], len);
+}
+
+/**
+ * @brief   copy received data at offset
+*/
+static void fs_rx_copy(uint8_t *dst, const MCU_CIRCULAR_SPAN *span, uint16_t offset, uint16_t len)
+{
+    uint16_t first;
+
+    if (offset < span->Len[0])
+    {
+        first = span->Len[0] - offset;
+        if (first > len)
+            first = len;
+        memcpy(dst, &span->Ptr[0][offset], first);
+        dst += first;
+        offset = 0;
+        len -= first;
+    }
+    else
+    {
+        offset -= span->Len[0];
+    }
+
+    memcpy(dst, &span->Ptr[1][offset], len);
+}
+
+/**
+ * @brief   drop received byte, restart incomplete frame timeout
+*/
+static void fs_rx_discard(uint16_t len)
+{
+    FS.rx_discard += len;
+    FS.rx_partial = 0;
+    timer_wheel_stop(&FS.rx_partial_tmr);
+    MCUCircular_Consume(&FS.cbCtx, len);
+}
+
+/**
+ * @brief   incomplete frame timeout, scan again to drop it
+ *          timer wheel callback
+*/
+static void fs_rx_partial_timer(TW_Timer_t *timer, void *arg)
+{
+    fs_comm_notify();
+}
+
+/**
+ * @brief   incomplete frame on buffer, drop it when rest never come
+ * @return  1: timeout, header byte dropped
+*/
+static uint8_t fs_rx_partial_timeout(void)
+{
+    if (!FS.rx_partial)
+    {
+        FS.rx_partial = 1;
+        timer_wheel_start(&FS.rx_partial_tmr, FS_RX_PARTIAL_TIMEOUT, 0, fs_rx_partial_timer, NULL);
+        return 0;
+    }
+
+    if (timer_wheel_is_running(&FS.rx_partial_tmr))
+        return 0;
+
+    FS.rx_partial_drop++;
+    fs_rx_discard(1);
+    return 1;
+}
 
 /**
  * @brief process fs uart data 
+ *        frame: [0xFF] ['F'] ['S'] [len] [data 0] .. [data len-1]
+ *               [0xFF] ['F'] ['X'] [len] [data 0] .. [data len-1] [crc hi] [crc lo]
+ *        header searched in bulk on contiguous span, whole frame consumed
+ *        once complete, partial frame left on buffer till next call
+ *        (dropped after FS_RX_PARTIAL_TIMEOUT)
+ *        on bad header or checksum only first byte dropped, so a real
+ *        header inside discarded frame is found on next search
  * 
  * @note    handler circular buffer content
  *          call at loop
+ * @return  1: frame received on FS.rx_buffer ([0]: len, [1..]: data),
+ *             frame type on FS.rx_type
 */
 uint8_t fs_comm_scan_data(void)
 {
-	int i, len;
-    static int rx_index = -3;
-    uint8_t data_out = 0;
+    MCU_CIRCULAR_SPAN span;
+    const uint8_t *found;
+    uint16_t len, frame_total;
+    uint8_t frame_len, type;
+    uint16_t crc;
+
+    /** buffer overwritten by DMA, content not reliable */
+    if (FS.rx_flush)
+    {
+        FS.rx_flush = 0;
+        fs_rx_discard(MCUCircular_GetDataLen(&FS.cbCtx));
+    }
 
-    TimeoutSet(&FS.timeout, 100);
+    len = MCUCircular_GetDataLen(&FS.cbCtx);
+    if (len > FS.rx_level_max)
+    {
+        FS.rx_level_max = len;
+    }
 
-    while( (len = MCUCircular_GetDataLen(&FS.cbCtx)) > 0 )
+    while ( (len = MCUCircular_Peek(&FS.cbCtx, &span)) > 0 )
     {
-        if (IsTimeout(&FS.timeout))
+        /** drop everything before header, searched on first span */
+        found = memchr(span.Ptr[0], FS_HEADER1, span.Len[0]);
+        if (found != span.Ptr[0])
         {
+            fs_rx_discard(found ? (found - span.Ptr[0]) : span.Len[0]);
+            continue;
+        }
+
+        /** wait rest of header */
+        if (len < FS_HEADER_LEN)
+        {
+            if (fs_rx_partial_timeout())
+                continue;
             return 0;
         }
-        /** get uart data */
-        if (MCUCircular_GetData(&FS.cbCtx, &data_out, 1) == 0)
-        {}
-        switch(rx_index)
+
+        type = fs_rx_byte(&span, 2);
+        frame_len = fs_rx_byte(&span, 3);
+        if (fs_rx_byte(&span, 1) != FS_HEADER2 || frame_len == 0 ||
+            !((type == FS_HEADER3 && frame_len <= FS_SYSTEM_STATUS_DATA_LEN) ||
+              type == FS_HEADER3_EXT))
         {
-            case -3:
-                if (data_out == FS_HEADER1) rx_index = -2;
-                break;
-            case -2:
-                if (data_out == FS_HEADER2) rx_index = -1;
-                break;
-            case -1:
-                if (data_out == FS_HEADER3) rx_index = 0;
-                break;
+            /** not valid header, resync from next byte */
+            fs_rx_discard(1);
+            continue;
+        }
 
-            default:
-                FS.rx_buffer[rx_index++] = data_out;
-                if ( FS.rx_buffer[0] > FS_SYSTEM_STATUS_DATA_LEN )
-                {
-                    /** not valid length */
-                    rx_index = -3;
-                    return 0;
-                }
-                /** check len on buffer[0] */
-                if(rx_index >= FS_SYSTEM_STATUS_DATA_LEN + 1)
-                {
-                    rx_index = -3;
-                    return 1;
-                }
-                break;
+        /** wait rest of frame */
+        frame_total = FS_HEADER_LEN + frame_len;
+        if (type == FS_HEADER3_EXT)
+            frame_total += FS_CRC_LEN;
+
+        if (len < frame_total)
+        {
+            if (fs_rx_partial_timeout())
+                continue;
+            return 0;
+        }
+
+        if (type == FS_HEADER3_EXT)
+        {
+            /** checksum over [len] + data, on ring memory */
+            crc = fs_rx_crc16(&span, FS_HEADER_LEN - 1, 1 + frame_len);
+            if (crc != (((uint16_t) fs_rx_byte(&span, frame_total - 2) << 8) |
+                                    fs_rx_byte(&span, frame_total - 1)))
+            {
+                FS.rx_crc_error++;
+                fs_rx_discard(1);
+                continue;
+            }
         }
+
+        /** only valid frame copied out */
+        FS.rx_buffer[0] = frame_len;
+        fs_rx_copy(&FS.rx_buffer[1], &span, FS_HEADER_LEN, frame_len);
+
+        MCUCircular_Consume(&FS.cbCtx, frame_total);
+        FS.rx_partial = 0;
+        timer_wheel_stop(&FS.rx_partial_tmr);
+        FS.rx_type = type;
+
+        FS.rx_frames++;
+        FS.rx_irq_per_frame = FS.rx_irq_count;
+        FS.rx_irq_count = 0;
+        return 1;
     }
 
     return 0;
@@ -238,12 +763,111 @@ void fs_reset_default(void)
 
 /**
  * send system request status every n milisecond
+ * timer wheel callback, n adapted on fs_system_req()
+*/
+static void fs_system_req_timer(TW_Timer_t *timer, void *arg)
+{
+    fs_system_req();
+}
+
+/**
+ * @brief   next status request after ms
+*/
+static void fs_system_req_schedule(uint32_t ms)
+{
+    timer_wheel_start(&FS.poll.req, ms, 0, fs_system_req_timer, NULL);
+}
+
+/**
+ * @brief   status change expected soon, poll fast
+ *          call on key command sent
+*/
+void fs_system_req_boost(void)
+{
+    FS.poll.key_tick = HAL_GetTick();
+    FS.poll.key_pending = 1;
+    timer_wheel_start(&FS.poll.boost, FS_SYSTEM_REQ_BOOST_TIME, 0, NULL, NULL);
+
+    /** next request no later than fast interval */
+    if (FS.poll.interval > FS_SYSTEM_REQ_FAST_TIME)
+    {
+        FS.poll.interval = FS_SYSTEM_REQ_FAST_TIME;
+        fs_system_req_schedule(FS_SYSTEM_REQ_FAST_TIME);
+    }
+}
+
+/**
+ * @brief   module in transient state, status may change any time
+*/
+static uint8_t fs_system_req_fast(void)
+{
+    return (!FS.poll.replied ||
+            timer_wheel_is_running(&FS.poll.boost) ||
+            FS.config.data0.bit.wifi_status == FS_WIFI_SETUP_MODE ||
+            FS.config.data3.bit.factory_reset_status);
+}
+
+/**
+ * @brief   request system status now, next request scheduled on timer
+ *          wheel, interval adapted to module state
+ *          see. FS_SYSTEM_REQ_FAST_TIME
+ * @note    called on fs_comm_init(), then from timer
 */
 void fs_system_req(void)
 {
-    if (IsTimeout(&tmrSysReq))
+    FS_StatusPoll_t *p = &FS.poll;
+
+    if (fs_system_req_fast() || p->interval < FS_SYSTEM_REQ_FAST_TIME)
+    {
+        p->interval = FS_SYSTEM_REQ_FAST_TIME;
+    }
+    else if (p->interval < FS_SYSTEM_REQ_TIME)
+    {
+        /** idle, back off */
+        p->interval *= 2;
+        if (p->interval > FS_SYSTEM_REQ_TIME)
+            p->interval = FS_SYSTEM_REQ_TIME;
+    }
+
+    fs_system_req_schedule(p->interval);
+    fs_comm_send_command(KC_SYSTEM_STATUS_REQ, 0x00);
+    p->req_count++;
+}
+
+/**
+ * @brief   system status reply received, update latency statistic
+ *          and polling interval
+ * @param   status  FS_SYSTEM_STATUS_DATA_LEN status byte
+*/
+void fs_system_req_reply(const uint8_t *status)
+{
+    FS_StatusPoll_t *p = &FS.poll;
+    uint32_t now = HAL_GetTick();
+
+    if (p->replied && memcmp(p->status, status, FS_SYSTEM_STATUS_DATA_LEN) != 0)
     {
-        TimeoutSet(&tmrSysReq, FS_SYSTEM_REQ_TIME);
-        fs_comm_send_command(KC_SYSTEM_STATUS_REQ, 0x00);
+        /** changed somewhere after previous reply */
+        p->change_latency = now - p->reply_tick;
+        if (p->change_latency > p->change_latency_max)
+            p->change_latency_max = p->change_latency;
+
+        if (p->key_pending)
+        {
+            p->key_pending = 0;
+            p->key_latency = now - p->key_tick;
+            if (p->key_latency > p->key_latency_max)
+                p->key_latency_max = p->key_latency;
+        }
+
+        /** more change may follow, poll fast again */
+        if (p->interval > FS_SYSTEM_REQ_FAST_TIME)
+        {
+            p->interval = FS_SYSTEM_REQ_FAST_TIME;
+            fs_system_req_schedule(FS_SYSTEM_REQ_FAST_TIME);
+        }
     }
+
+    memcpy(p->status, status, FS_SYSTEM_STATUS_DATA_LEN);
+    p->reply_tick = now;
+    p->replied = 1;
 }
@@ -14,13 +14,25 @@
 #include <stdint.h>
 #include "utility/circular_buffer.h"
 #include "utility/timeout.h"
+#include "utility/timer_wheel.h"
+#include "utility/scheduler.h"
 
 /** FS packet format 
  * [0XFF] + ['F'] + ['S'] + [len] + [D0] + [D1] 
+ *
+ * extended packet format, variable length with checksum
+ * [0XFF] + ['F'] + ['X'] + [len] + [D0] .. [Dlen-1] + [CRC hi] + [CRC lo]
+ * CRC-16/CCITT-FALSE over [len] + data, len 1 - 255
+ * status frame data start with same 4 byte as FS_HEADER3 frame,
+ * following byte reserved for richer status
 */
 #define FS_HEADER1  (0xFF)
 #define FS_HEADER2  ('F')   //0x46
 #define FS_HEADER3  ('S')   //0x53
+#define FS_HEADER3_EXT  ('X')   //0x58
+#define FS_HEADER_LEN   (4) /** header + len */
+#define FS_CRC_LEN      (2) /** extended frame checksum */
+#define FS_FRAME_DATA_MAX   (255)
 
 #define FS_KEY_COMMAND_DATA_LEN     (2) /* currenly limited to max 2*/
 #define FS_KEY_COMMAND_PACKET_LEN   (6)
@@ -53,7 +65,28 @@
 /** key command data_1 */
 #define KC_EVENT_KEY_PRESSED    (0x80)
 
-#define FS_SYSTEM_REQ_TIME      (1000)   /** set to 1000 ms */
+/** adaptive system status polling, see. fs_system_req()
+ * - fast interval on boot (no reply yet), network setup, factory reset
+ *   and for FS_SYSTEM_REQ_BOOST_TIME after key command sent
+ * - fast interval again after status changed
+ * - otherwise interval doubled each request up to FS_SYSTEM_REQ_TIME
+*/
+#define FS_SYSTEM_REQ_TIME      (1000)   /** set to 1000 ms, slowest interval */
+#define FS_SYSTEM_REQ_FAST_TIME     (50)    /** fastest interval (ms) */
+#define FS_SYSTEM_REQ_BOOST_TIME    (1000)  /** fast polling after key command (ms) */
+
+/** key command scheduler, see. fs_comm_scheduler_handler()
+ * - volume up / down / set merged to one absolute KC_SET_VOLUME
+ * - mode command (spotify, bluetooth) latest one win
+ * - system status request sent once
+ * - other key command sent in order, standby is toggle so never merged
+ *   (pending mode command queued ahead of it to keep press order)
+*/
+#define FS_CMD_FRAME_GAP            (20)    /** min gap between key command frame (ms) */
+#define FS_CMD_QUEUE_LEN            (8)     /** ordered key command */
+#define FS_CMD_NONE                 (0xFF)
+#define FS_VOLUME_MAX               (32)
+#define FS_VOLUME_SETTLE_TIME       (1000)  /** follow module volume after last set (ms) */
 
 /**
  * !!!
@@ -186,8 +219,66 @@ typedef struct
 
 
 /******************** Comm Resource **********************/
-#define FS_SYSTEM_STATUS_BUFF_LEN   6
-#define FS_CIRCULAR_BUFF_LEN        12*2
+#define FS_SYSTEM_STATUS_BUFF_LEN   (1 + FS_FRAME_DATA_MAX)  /** len + data */
+/** must hold at least one longest extended frame, power of 2 */
+#define FS_CIRCULAR_BUFF_LEN        512
+
+/** incomplete frame dropped when rest not received within (ms) */
+#define FS_RX_PARTIAL_TIMEOUT       50
+
+/**
+ * uart receive engine
+ * 1: circular DMA (DMA1 channel 5) into circular_buffer, write index 
+ *    updated on IDLE line (one interrupt per frame) and DMA half / full
+ * 0: RXNE interrupt, one interrupt per byte
+*/
+#define FS_UART_USE_DMA             (1)
+
+/**
+ * uart transmit engine
+ * 1: key command queued on tx ring, sent by TXE interrupt
+ * 0: blocking send, wait TXE every byte
+*/
+#define FS_UART_TX_USE_IT           (1)
+#define FS_TX_CIRCULAR_BUFF_LEN     64      /** power of 2, 10 key command frame */
+
+#if (!MCU_CIRCULAR_POW2(FS_CIRCULAR_BUFF_LEN) || !MCU_CIRCULAR_POW2(FS_TX_CIRCULAR_BUFF_LEN))
+#error "FS_CIRCULAR_BUFF_LEN and FS_TX_CIRCULAR_BUFF_LEN must be power of 2"
+#endif
+
+typedef struct
+{
+    uint8_t queue[FS_CMD_QUEUE_LEN][FS_KEY_COMMAND_DATA_LEN];
+    uint8_t head;
+    uint8_t tail;
+    uint8_t mode_cmd;               // pending mode command, FS_CMD_NONE: none
+    uint8_t mode_data;
+    uint8_t status_req;             // pending system status request
+    uint8_t volume_pending;         // volume_target not yet sent
+    int8_t volume_target;           // absolute volume, -1: follow module volume
+    TW_Timer_t gap;                 // running: frame gap after last key command
+    TW_Timer_t volume_settle;       // running: module volume not yet settled
+    uint32_t merged;                // key command merged or superseded
+}FS_CmdScheduler_t;
+
+typedef struct
+{
+    TW_Timer_t req;                 // next status request
+    TW_Timer_t boost;               // running: fast poll after key command
+    uint16_t interval;              // current request interval (ms)
+    uint8_t replied;                // status reply received at least once
+    uint8_t key_pending;            // key command sent, status not changed yet
+    uint8_t status[FS_SYSTEM_STATUS_DATA_LEN];  // last status reply
+    uint32_t reply_tick;            // tick of last status reply
+    uint32_t key_tick;              // tick of last key command sent
+    uint32_t req_count;             // status request sent
+
+    /** latency statistic (ms) */
+    uint32_t change_latency;        // change seen to previous reply, staleness bound
+    uint32_t change_latency_max;
+    uint32_t key_latency;           // key command sent to status changed
+    uint32_t key_latency_max;
+}FS_StatusPoll_t;
 
 typedef struct
 {
@@ -195,14 +286,47 @@ typedef struct
     uint8_t circular_buffer[FS_CIRCULAR_BUFF_LEN];
     MCU_CIRCULAR_CONTEXT cbCtx;
     uint8_t rx_buffer[FS_SYSTEM_STATUS_BUFF_LEN];
-    TIMER timeout;
     FS_SystemStatus config, preConfig;
+
+    /** receive interrupt statistic */
+    uint32_t rx_irq_count;          // interrupt since last complete frame
+    uint32_t rx_irq_per_frame;      // interrupt on last complete frame
+    uint32_t rx_frames;             // valid frame received
+    uint32_t rx_discard;            // byte discarded on resync
+    uint32_t rx_crc_error;          // extended frame dropped on checksum mismatch
+    uint32_t rx_partial_drop;       // incomplete frame dropped on timeout
+    uint8_t rx_type;                // header type of last frame, FS_HEADER3(_EXT)
+
+    /** receive error statistic */
+    uint32_t rx_overrun;            // uart overrun, byte lost before read
+    uint32_t rx_frame_error;        // uart framing error (stop bit)
+    uint32_t rx_noise_error;        // uart noise detected
+    uint32_t rx_overflow;           // circular buffer full, received byte lost
+    uint16_t rx_level_max;          // circular buffer high-water (byte)
+    volatile uint8_t rx_flush;      // buffer overwritten by DMA, flush on next scan
+    uint8_t rx_partial;             // waiting rest of frame, rx_partial_tmr running
+    TW_Timer_t rx_partial_tmr;
+
+    uint8_t tx_circular_buffer[FS_TX_CIRCULAR_BUFF_LEN];
+    MCU_CIRCULAR_CONTEXT txCtx;
+    uint32_t tx_drop;               // key command rejected, tx ring full
+    uint32_t tx_block_cycles_max;   // longest key command frame send (core cycle)
+
+    FS_CmdScheduler_t sched;
+    FS_StatusPoll_t poll;
+
+    SCH_Task_t *task;               // signaled on receive and queued command, NULL: none
 }FrontierSilicon_t;
 
 /** prototype function */
 void fs_comm_init(void);
+void fs_comm_attach_task(SCH_Task_t *task);
 void FS_USART_IRQ_Handler(void);
+#if (FS_UART_USE_DMA)
+void FS_DMA_RX_IRQ_Handler(void);
+#endif
 int fs_comm_send_command(uint8_t command, uint8_t data);
+void fs_comm_scheduler_handler(void);
 uint8_t fs_comm_scan_data(void);
 
 uint8_t fs_comm_get_wifi_status(void);
@@ -215,6 +339,8 @@ uint8_t fs_comm_get_err_wifi_reconnection(void);
 uint8_t fs_comm_get_factory_status(void);
 void fs_reset_default(void);
 void fs_system_req(void);
+void fs_system_req_boost(void);
+void fs_system_req_reply(const uint8_t *status);
 /* end of prototype function */
 
 /** extern resource */
@@ -0,0 +1,257 @@
+/**
+ * @file fs_sim.c
+ * @brief   Venice X (FS4340) module simulator on virtual uart
+ *          run whole FS communication (scheduler, parser, adaptive
+ *          polling, main task state machine) without FS4340 module
+ * 
+ *          - key command frame taken from FS.txCtx instead of uart
+ *          - system status reply put on FS.cbCtx, parsed as uart data
+ *          - module status follow scripted scenario and key command
+ *          - module time on HAL tick, same clock as firmware timer
+ * 
+ */
+#include <stdint.h>
+#include <string.h>
+#include "fs_sim.h"
+#include "fs_comm.h"
+#include "main.h"
+#include "utility/crc.h"
+
+#if (CONFIG_FS_SIMULATOR)
+
+/** status byte helper */
+#define D0(wifi, bt)        (uint8_t)(((bt) << 4) | (wifi))
+#define D1(mode, spotify)   (uint8_t)(((spotify) << 4) | (mode))
+#define D2(vol, mute)       (uint8_t)(((mute) << 7) | (vol))
+
+static const FS_SimStep_t fs_sim_boot[] =
+{
+    {    0, FS_SIM_STEP_SILENT, {0, 0, 0, 0} },
+    { 3000, 0,                  {D0(FS_WIFI_STATE_DISCONNECTED, FS_BT_DISCONNECTED), D1(FS_NO_MODE, 0), D2(15, 0), 0} },
+    { 6000, FS_SIM_STEP_PUSH,   {D0(FS_WIFI_STATE_CONNECTED, FS_BT_DISCONNECTED), D1(FS_MODE_SPOTIFY, FS_SPOTIFY_ACCOUNT_LOGOUT), D2(15, 0), 0} },
+    { 8000, FS_SIM_STEP_END,    {D0(FS_WIFI_STATE_CONNECTED, FS_BT_DISCONNECTED), D1(FS_MODE_SPOTIFY, FS_SPOTIFY_ACCOUNT_LOGIN), D2(15, 0), 0} },
+};
+
+static const FS_SimStep_t fs_sim_wifi_setup[] =
+{
+    {     0, FS_SIM_STEP_SILENT, {0, 0, 0, 0} },
+    {  3000, 0,                  {D0(FS_WIFI_STATE_DISCONNECTED, FS_BT_DISCONNECTED), D1(FS_NO_MODE, 0), D2(15, 0), 0} },
+    {  5000, 0,                  {D0(FS_WIFI_SETUP_MODE, FS_BT_DISCONNECTED), D1(FS_MODE_SPOTIFY, 0), D2(15, 0), 0} },
+    { 35000, 0,                  {D0(FS_WIFI_STATE_CONNECTED, FS_BT_DISCONNECTED), D1(FS_MODE_SPOTIFY, FS_SPOTIFY_ACCOUNT_LOGOUT), D2(15, 0), 0} },
+    { 37000, FS_SIM_STEP_END,    {D0(FS_WIFI_STATE_CONNECTED, FS_BT_DISCONNECTED), D1(FS_MODE_SPOTIFY, FS_SPOTIFY_ACCOUNT_LOGIN), D2(15, 0), 0} },
+};
+
+static const FS_SimStep_t fs_sim_mode_switch[] =
+{
+    {     0, 0,                {D0(FS_WIFI_STATE_CONNECTED, FS_BT_DISCONNECTED), D1(FS_MODE_SPOTIFY, FS_SPOTIFY_PAUSED), D2(15, 0), 0} },
+    {  2000, FS_SIM_STEP_PUSH, {D0(FS_WIFI_STATE_CONNECTED, FS_BT_DISCONNECTED), D1(FS_MODE_SPOTIFY, FS_SPOTIFY_PLAYING), D2(15, 0), 0} },
+    {  5000, FS_SIM_STEP_PUSH, {D0(FS_WIFI_STATE_CONNECTED, FS_BT_DISCOVERABLE), D1(FS_MODE_BLUETOOTH, 0), D2(15, 0), 0} },
+    {  8000, 0,                {D0(FS_WIFI_STATE_CONNECTED, FS_BT_CONNECTED), D1(FS_MODE_BLUETOOTH, 0), D2(20, 0), 0} },
+    { 11000, FS_SIM_STEP_PUSH, {D0(FS_WIFI_STATE_CONNECTED, FS_BT_DISCONNECTED), D1(FS_MODE_SPOTIFY, FS_SPOTIFY_PAUSED), D2(20, 0), 0} },
+    { 14000, FS_SIM_STEP_END,  {D0(FS_WIFI_STATE_CONNECTED, FS_BT_DISCONNECTED), D1(FS_MODE_STANDBY, 0), D2(20, 1), 0} },
+};
+
+static const FS_SimStep_t fs_sim_factory_reset[] =
+{
+    {     0, 0,                  {D0(FS_WIFI_STATE_CONNECTED, FS_BT_DISCONNECTED), D1(FS_MODE_SPOTIFY, FS_SPOTIFY_PLAYING), D2(15, 0), 0} },
+    {  2000, FS_SIM_STEP_PUSH,   {D0(FS_WIFI_STATE_CONNECTED, FS_BT_DISCONNECTED), D1(FS_MODE_SPOTIFY, FS_SPOTIFY_PLAYING), D2(15, 0), FS_ERR_STATUS_UPGRADE} },
+    {  4000, FS_SIM_STEP_SILENT, {0, 0, 0, 0} },
+    { 10000, 0,                  {D0(FS_WIFI_STATE_DISCONNECTED, FS_BT_DISCONNECTED), D1(FS_NO_MODE, 0), D2(15, 0), 0} },
+    { 12000, FS_SIM_STEP_END,    {D0(FS_WIFI_SETUP_MODE, FS_BT_DISCONNECTED), D1(FS_MODE_SPOTIFY, 0), D2(15, 0), 0} },
+};
+
+/** module answer late (first reply 2.87 s after power on), status only
+ * on request, raw status byte, hand written (not a module capture)
+ */
+static const FS_SimStep_t fs_sim_late_boot[] =
+{
+    {    0, FS_SIM_STEP_SILENT, {0x00, 0x00, 0x00, 0x00} },
+    { 2870, 0,                  {0x00, 0x00, 0x0F, 0x00} },
+    { 5120, 0,                  {0x01, 0x02, 0x0F, 0x00} },
+    { 5890, FS_SIM_STEP_END,    {0x01, 0x12, 0x0F, 0x00} },
+};
+
+static const FS_SimStep_t * const fs_sim_scenario[] =
+{
+    [FS_SIM_SCENARIO_BOOT]          = fs_sim_boot,
+    [FS_SIM_SCENARIO_WIFI_SETUP]    = fs_sim_wifi_setup,
+    [FS_SIM_SCENARIO_MODE_SWITCH]   = fs_sim_mode_switch,
+    [FS_SIM_SCENARIO_FACTORY_RESET] = fs_sim_factory_reset,
+    [FS_SIM_SCENARIO_LATE_BOOT]     = fs_sim_late_boot,
+};
+
+FS_Sim_t fs_sim;
+
+/**
+ * @brief   start scenario from first step
+*/
+static void fs_sim_start(const FS_SimStep_t *scenario)
+{
+    fs_sim.step = scenario;
+    fs_sim.start_tick = HAL_GetTick();
+    fs_sim.time = 0;
+    fs_sim.reply_pending = 0;
+    fs_sim.silent = (scenario->flags & FS_SIM_STEP_SILENT) ? 1 : 0;
+    memcpy(fs_sim.status, scenario->status, sizeof(fs_sim.status));
+}
+
+void fs_sim_init(void)
+{
+    fs_sim_start(fs_sim_scenario[CONFIG_FS_SIM_SCENARIO]);
+}
+
+/**
+ * @brief   put system status frame on FS receive buffer
+*/
+static void fs_sim_send_status(void)
+{
+    uint8_t frame[FS_HEADER_LEN + FS_SYSTEM_STATUS_DATA_LEN + FS_CRC_LEN];
+    uint8_t len = FS_HEADER_LEN + FS_SYSTEM_STATUS_DATA_LEN;
+#if (FS_SIM_EXT_FRAME)
+    uint16_t crc;
+#endif
+
+    frame[0] = FS_HEADER1;
+    frame[1] = FS_HEADER2;
+    frame[2] = FS_HEADER3;
+    frame[3] = FS_SYSTEM_STATUS_DATA_LEN;
+    memcpy(&frame[FS_HEADER_LEN], fs_sim.status, FS_SYSTEM_STATUS_DATA_LEN);
+
+#if (FS_SIM_EXT_FRAME)
+    frame[2] = FS_HEADER3_EXT;
+    crc = crc16(CRC16_INIT, &frame[3], 1 + FS_SYSTEM_STATUS_DATA_LEN);
+    frame[len++] = (uint8_t)(crc >> 8);
+    frame[len++] = (uint8_t)(crc);
+#endif
+
+    if (MCUCircular_GetSpaceLen(&FS.cbCtx) >= len)
+    {
+        MCUCircular_PutData(&FS.cbCtx, frame, len);
+        FS.rx_irq_count++;
+        fs_sim.reply_count++;
+    }
+}
+
+/**
+ * @brief   module reaction on key command
+*/
+static void fs_sim_key_command(uint8_t command, uint8_t data)
+{
+    int16_t volume = fs_sim.status[2] & 0x7F;
+
+    fs_sim.key_count++;
+
+    switch (command)
+    {
+        case KC_SYSTEM_STATUS_REQ:
+            break;
+
+        case KC_CLEAR_ERROR_FLAGS:
+            fs_sim.status[3] &= ~data;
+            break;
+
+        case KC_UNMUTE:
+            fs_sim.status[2] &= 0x7F;
+            break;
+
+        case KC_MUTE:
+            fs_sim.status[2] |= 0x80;
+            break;
+
+        case KC_SPOTIFY_MODE:
+            fs_sim.status[1] = D1(FS_MODE_SPOTIFY, FS_SPOTIFY_PAUSED);
+            break;
+
+        case KC_BLUETOOTH_MODE:
+            fs_sim.status[1] = D1(FS_MODE_BLUETOOTH, 0);
+            break;
+
+        case KC_STANDBY:
+            fs_sim.status[1] = D1(FS_MODE_STANDBY, 0);
+            break;
+
+        case KC_SET_VOLUME:
+        case KC_VOLUME_UP:
+        case KC_VOLUME_DOWN:
+            if (command == KC_VOLUME_UP)
+                volume++;
+            else if (command == KC_VOLUME_DOWN)
+                volume--;
+            else
+                volume = data;
+
+            if (volume < 0) volume = 0;
+            if (volume > FS_VOLUME_MAX) volume = FS_VOLUME_MAX;
+            fs_sim.status[2] = (fs_sim.status[2] & 0x80) | (uint8_t) volume;
+            break;
+
+        case KC_PLAY_PAUSE:
+            if ((fs_sim.status[1] & 0x0F) == FS_MODE_SPOTIFY)
+            {
+                fs_sim.status[1] ^= (FS_SPOTIFY_PAUSED ^ FS_SPOTIFY_PLAYING) << 4;
+            }
+            break;
+
+        case KC_RESET_NETWORK:
+            fs_sim_start(fs_sim_wifi_setup);
+            return;
+
+        case KC_FACTORY_RESET:
+            fs_sim_start(fs_sim_factory_reset);
+            return;
+
+        default:
+            break;
+    }
+
+    /** status request and state change answered with status */
+    if (!fs_sim.silent)
+    {
+        fs_sim.reply_pending = 1;
+        fs_sim.reply_time = fs_sim.time + FS_SIM_REPLY_DELAY;
+    }
+}
+
+/**
+ * @brief   run module simulator, call at loop before fs_comm_scan_data()
+*/
+void fs_sim_handler(void)
+{
+    uint8_t frame[FS_KEY_COMMAND_PACKET_LEN];
+
+    fs_sim.time = HAL_GetTick() - fs_sim.start_tick;
+
+    /** scripted step */
+    while (!(fs_sim.step->flags & FS_SIM_STEP_END) && fs_sim.time >= fs_sim.step[1].time)
+    {
+        fs_sim.step++;
+        fs_sim.silent = (fs_sim.step->flags & FS_SIM_STEP_SILENT) ? 1 : 0;
+        memcpy(fs_sim.status, fs_sim.step->status, sizeof(fs_sim.status));
+
+        if (fs_sim.step->flags & FS_SIM_STEP_PUSH)
+        {
+            fs_sim_send_status();
+        }
+    }
+
+    /** key command from virtual uart, always whole frame on tx ring */
+    while (MCUCircular_GetDataLen(&FS.txCtx) >= FS_KEY_COMMAND_PACKET_LEN)
+    {
+        MCUCircular_GetData(&FS.txCtx, frame, FS_KEY_COMMAND_PACKET_LEN);
+        if (frame[0] == FS_HEADER1 && frame[1] == FS_HEADER2 && frame[2] == FS_HEADER3)
+        {
+            fs_sim_key_command(frame[4], frame[5]);
+        }
+    }
+
+    if (fs_sim.reply_pending && fs_sim.time >= fs_sim.reply_time)
+    {
+        fs_sim.reply_pending = 0;
+        if (!fs_sim.silent)
+        {
+            fs_sim_send_status();
+        }
+    }
+}
+
+#endif  /** end of CONFIG_FS_SIMULATOR */
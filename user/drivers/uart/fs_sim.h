@@ -0,0 +1,67 @@
+/**
+ * @file fs_sim.h
+ * @brief   Venice X (FS4340) module simulator on virtual uart
+ *          key command taken from FS tx ring, system status reply put
+ *          on FS receive buffer, see. CONFIG_FS_SIMULATOR
+ * 
+ */
+#ifndef FS_SIM_H
+#define FS_SIM_H
+
+#include <stdint.h>
+#include "app_config.h"
+#include "fs_comm.h"
+
+#if (CONFIG_FS_SIMULATOR) && !(FS_UART_TX_USE_IT)
+#error "Venice X simulator take key command from tx ring, FS_UART_TX_USE_IT required"
+#endif
+
+/** scenario, see. CONFIG_FS_SIM_SCENARIO */
+#define FS_SIM_SCENARIO_BOOT            0   /** power on, network connect, spotify */
+#define FS_SIM_SCENARIO_WIFI_SETUP      1   /** power on without network, setup mode */
+#define FS_SIM_SCENARIO_MODE_SWITCH     2   /** spotify / bluetooth switch by module */
+#define FS_SIM_SCENARIO_FACTORY_RESET   3   /** factory reset, reboot, setup mode */
+#define FS_SIM_SCENARIO_LATE_BOOT       4   /** late first reply, no push, see. fs_sim_late_boot[] */
+
+/** module reply time after key command received (ms) */
+#define FS_SIM_REPLY_DELAY              10
+
+/** reply with extended frame (['F'] ['X'] + crc) instead of ['F'] ['S'] */
+#define FS_SIM_EXT_FRAME                (0)
+
+/** scenario step flag */
+#define FS_SIM_STEP_SILENT      (1<<0)  /** module not answer (booting, rebooting) */
+#define FS_SIM_STEP_PUSH        (1<<1)  /** status sent without request */
+#define FS_SIM_STEP_END         (1<<7)  /** end of scenario, last status kept */
+
+typedef struct
+{
+    uint32_t time;                  // module time from scenario start (ms)
+    uint8_t flags;                  // FS_SIM_STEP_x
+    uint8_t status[4];              // system status data 0 - 3
+}FS_SimStep_t;
+
+typedef struct
+{
+    const FS_SimStep_t *step;       // current step of scenario
+    uint32_t start_tick;
+    uint32_t time;                  // module time (ms) from scenario start
+    uint8_t status[4];              // status reported by module
+    uint8_t silent;
+    uint8_t reply_pending;
+    uint32_t reply_time;
+
+    uint32_t key_count;             // key command received
+    uint32_t reply_count;           // status frame sent
+}FS_Sim_t;
+
+/** prototype function */
+void fs_sim_init(void);
+void fs_sim_handler(void);
+/** end of prototype function */
+
+/** extern resource */
+extern FS_Sim_t fs_sim;
+/** end of extern resource */
+
+#endif /*FS_SIM_H*/
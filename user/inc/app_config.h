@@ -81,5 +81,53 @@
 #define CONFIG_WAIT_CHANGE_MODE_VENICEX     (1)
 #define CONFIG_ROLLING_MODE                 (1)
 
+/** host interrupt (HOST_INT, PB12 open drain) asserted low while
+ * register change pending, see. REG_CHANGE_FLAGS
+ * 1: enable
+ * 0: disable, master must poll
+*/
+#define CONFIG_I2C_HOST_INT_ENABLE          (1)
+
+/** I2C1 slave bus speed profile
+ * 0: standard mode, 100 kHz
+ * 1: fast mode, 400 kHz (I2C_SLAVE_USE_DMA required to keep
+ *    clock stretching within budget, see. i2c_slave.h)
+*/
+#define CONFIG_I2C_FAST_MODE                (0)
+
+/** SMBus packet error checking (CRC-8) on I2C register access
+ * write: [register] [data ...] [PEC], rejected when PEC mismatch
+ * read:  from start register till end of its read group, followed by
+ *        PEC (see. i2c_read_group)
+ * 1: enable
+ * 0: disable
+*/
+#ifndef CONFIG_I2C_PEC_ENABLE
+#define CONFIG_I2C_PEC_ENABLE               (0)
+#endif
+
+/** Venice X module simulator, see. drivers/uart/fs_sim.c
+ * USART1 not used, key command and system status exchanged on
+ * virtual uart (FS tx / rx buffer) with scripted module
+ * 1: enable, development only
+ * 0: disable, simulator not built on firmware image
+ * default off, host test build set it on command line
+ * (see. test/test_fs_sim.c)
+*/
+#ifndef CONFIG_FS_SIMULATOR
+#define CONFIG_FS_SIMULATOR                 (0)
+#endif
+/** scenario, see. FS_SIM_SCENARIO_x */
+#ifndef CONFIG_FS_SIM_SCENARIO
+#define CONFIG_FS_SIM_SCENARIO              (0)
+#endif
+
+/** tickless idle, 1 ms SysTick suspended while sleeping longer than
+ * LP_TICKLESS_MIN (see. utility/low_power.h), tick compensated on wake
+ * 1: enable
+ * 0: disable, sleep (WFI) with 1 ms tick
+*/
+#define CONFIG_LOW_POWER_TICKLESS           (1)
+
 
 #endif /* APP_CONFIG_H */
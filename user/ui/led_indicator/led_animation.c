@@ -1,3 +1,4 @@
+#include <string.h>
 #include "led_animation.h"
 #include "app_config.h"
 #include "apps/sys_app.h"
@@ -39,6 +40,10 @@ uint16_t timeChange_potition = 200;
 uint32_t timeUpdate_LED_Cnt = 0;
 
 static uint8_t bs_speaker_mode = 0;
+
+/* frame streamed by host (R G B per LED), shown instead of animation while active */
+static uint8_t host_frame[CONFIG_LED_NUMBER * 3];
+static uint8_t host_frame_active = 0;
 /* ========================== End Declerasi Variable Control Protype ======================== */
 
 /* =============================== Function Control Animation LED =========================== */
@@ -79,6 +84,31 @@ void Audio_Sys_Init(void)
 
 	warna = Wheel(Cnt_WheelColor);
 }
+/**
+ * @brief	latch frame from host, drawn on next Draw_Anim tick
+ * @param	rgb		R G B per LED, CONFIG_LED_NUMBER LED
+ * @param	active	1: show host frame, 0: back to animation
+ */
+void led_host_frame_commit(const uint8_t *rgb, uint8_t active)
+{
+	if (active)
+		memcpy(host_frame, rgb, sizeof(host_frame));
+
+	host_frame_active = active;
+}
+
+/**
+ * @brief	draw host frame, no rendering on MCU
+ */
+static void led_host_frame_draw(void)
+{
+	for (uint8_t i = 0; i < CONFIG_LED_NUMBER; i++)
+	{
+		ws2812_setPixelColor(i, ws2812_color(host_frame[i * 3], 
+											host_frame[i * 3 + 1], 
+											host_frame[i * 3 + 2]));
+	}
+}
 /* ----------------------------------------------------------------------------------------- */
 /* *******************		User Prototype Function-2 Handler-ANIMATION		******************** */
 void Audio_Sys_Handler(void)
@@ -369,6 +399,14 @@ void Draw_Anim(void) /* write animasi */
 	{
 		timeUpdate_LED_Cnt = GET_TICK();
 
+		/* frame from host (I2C), skip animation */
+		if (host_frame_active)
+		{
+			led_host_frame_draw();
+			ws2812_show();
+			return;
+		}
+
 		/* Call update Animation mode function. */
 		updateMode_Anim();
 
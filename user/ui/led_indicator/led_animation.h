@@ -22,6 +22,7 @@ void save_last_mode(void);
 void set_vol_display(uint8_t vol);
 void set_broadcast_display(SystemConfig_t *cfg);
 void set_speaker_mode_display(SystemConfig_t *cfg);
+void led_host_frame_commit(const uint8_t *rgb, uint8_t active);
 /** end of prototype function */
 
 /** extern resources */
@@ -4,12 +4,12 @@
 */
 #include "main.h"
 #include "app_config.h"
-#include "utility/timeout.h"
+#include "utility/timer_wheel.h"
 
 #define USER_LED_PORT   LED_R_GPIO_Port
 #define USER_LED_PIN    LED_R_Pin
 
-TIMER timer_user_led;
+TW_Timer_t timer_user_led;
 
 #define LED_BLINK_MODE_SYS_CYCLE        1
 #define LED_BLINK_MODE_BLINK_TICK       2
@@ -26,9 +26,19 @@ static uint32_t count_led = 0;
 
 #endif
 
+#if (BLINK_MODE==LED_BLINK_MODE_BLINK_PERIODE)
+static void user_led_toggle(TW_Timer_t *timer, void *arg)
+{
+    // toggle led on PA0
+    HAL_GPIO_TogglePin(USER_LED_GPIO_Port, USER_LED_Pin);
+}
+#endif
+
 void user_led_init(void)
 {
-    TimeoutSet(&timer_user_led, 500);
+#if (BLINK_MODE==LED_BLINK_MODE_BLINK_PERIODE)
+    timer_wheel_start(&timer_user_led, 500, 500, user_led_toggle, NULL);
+#endif
 }
 
 
@@ -36,11 +46,7 @@ void user_led_run(void)
 {
 
 #if (BLINK_MODE==LED_BLINK_MODE_BLINK_PERIODE)
-    if (IsTimeout(&timer_user_led) ) {
-        // toggle led on PA0
-        HAL_GPIO_TogglePin(USER_LED_GPIO_Port, USER_LED_Pin);
-        TimeoutSet(&timer_user_led, 500);
-    }
+    /** toggled on timer wheel, see. user_led_toggle() */
 #elif (BLINK_MODE==LED_BLINK_MODE_BLINK_TICK)
     if (count_led < T_ON) {
         HAL_GPIO_WritePin(USER_LED_GPIO_Port, USER_LED_Pin, GPIO_PIN_RESET);
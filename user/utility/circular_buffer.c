@@ -1,169 +1,262 @@
+#include <string.h>
 #include "circular_buffer.h"
-
-void MCUCircular_Config(MCU_CIRCULAR_CONTEXT* CircularBuf, void* Buf, uint32_t Len)
+#include "main.h"
+
+/**
+ * single producer / single consumer ring
+ * R and W free running (never wrapped), wrap on buffer by BufDepth - 1 mask,
+ * W - R is data length even when buffer full, so whole buffer usable
+ * producer only write W, consumer only write R, no lock needed between
+ * interrupt and main loop
+ * barrier order:
+ *   producer: copy data -> DMB -> publish W
+ *   consumer: read W -> DMB -> copy data -> DMB -> publish R
+ */
+
+/**
+ * @brief   config circular buffer
+ * @param   Len buffer length, power of 2
+ * @return  0: ok
+ *          -1: Len 0 or not power of 2, rejected, buffer left with no
+ *          space (put / reserve return 0)
+ */
+int32_t MCUCircular_Config(MCU_CIRCULAR_CONTEXT* CircularBuf, void* Buf, uint32_t Len)
 {
+    int32_t ret = 0;
+
+    if (!MCU_CIRCULAR_POW2(Len))
+    {
+        Len = 0;
+        ret = -1;
+    }
+
     CircularBuf->CircularBuf = Buf;
     CircularBuf->BufDepth = Len;
+    CircularBuf->Mask = Len - 1;
     CircularBuf->R = 0;
     CircularBuf->W = 0;
+
+    return ret;
 }
 
 int32_t MCUCircular_GetSpaceLen(MCU_CIRCULAR_CONTEXT* CircularBuf)
 {
-	if(CircularBuf->R == CircularBuf->W)
-	{
-		return CircularBuf->BufDepth;
-	}
-	else
-	{
-		return (CircularBuf->BufDepth + CircularBuf->R - CircularBuf->W) % CircularBuf->BufDepth;
-	}   
+    return (CircularBuf->BufDepth - (CircularBuf->W - CircularBuf->R));
 }
 
-void MCUCircular_PutData(MCU_CIRCULAR_CONTEXT* CircularBuf, void* InBuf, uint16_t Len)
+/**
+ * @brief   data from read index, in place, not consumed
+ *          Span->Ptr[1] used when data wrap at end of buffer
+ *          call MCUCircular_Consume() after data processed
+ * @return  total data length (Span->Len[0] + Span->Len[1])
+ */
+uint16_t MCUCircular_Peek(MCU_CIRCULAR_CONTEXT* CircularBuf, MCU_CIRCULAR_SPAN* Span)
 {
-    if(Len == 0)
-	{
-		return;
-	}
-	if(CircularBuf->W + Len <= CircularBuf->BufDepth)
+    uint32_t R = CircularBuf->R;
+    uint32_t Len = CircularBuf->W - R;
+    uint32_t Pos = R & CircularBuf->Mask;
+    uint32_t First = CircularBuf->BufDepth - Pos;
+
+    /** index read before data */
+    __DMB();
+
+    Span->Ptr[0] = (uint8_t *)&CircularBuf->CircularBuf[Pos];
+    Span->Ptr[1] = (uint8_t *)&CircularBuf->CircularBuf[0];
+    Span->Len[0] = (Len < First) ? Len : First;
+    Span->Len[1] = Len - Span->Len[0];
+
+    return Len;
+}
+
+/**
+ * @brief   give back data to producer, after peek / read
+ * @return  number of byte consumed
+ */
+int32_t MCUCircular_Consume(MCU_CIRCULAR_CONTEXT* CircularBuf, uint16_t Len)
+{
+    uint32_t Avail = CircularBuf->W - CircularBuf->R;
+
+    if(Len > Avail)
     {
-        memcpy((void *)&CircularBuf->CircularBuf[CircularBuf->W], InBuf, Len);
+        Len = Avail;
     }
-    else
+    if(Len == 0)
     {
-        memcpy((void *)&CircularBuf->CircularBuf[CircularBuf->W], InBuf, CircularBuf->BufDepth - CircularBuf->W);
-        memcpy((void *)&CircularBuf->CircularBuf[0], (uint8_t*)InBuf + CircularBuf->BufDepth - CircularBuf->W, CircularBuf->W + Len - CircularBuf->BufDepth);
+        return 0;
     }
-    CircularBuf->W = (CircularBuf->W + Len) % CircularBuf->BufDepth;    
+
+    /** data read done before slot given back to producer */
+    __DMB();
+    CircularBuf->R += Len;
+
+    return Len;
 }
 
-uint16_t MCUCircular_GetDataLen(MCU_CIRCULAR_CONTEXT* CircularBuf)
+/**
+ * @brief   free space from write index, written in place (e.g. by DMA)
+ *          Span->Ptr[1] used when space wrap at end of buffer
+ *          call MCUCircular_Commit() after data written
+ * @return  total space length (Span->Len[0] + Span->Len[1])
+ */
+uint16_t MCUCircular_Reserve(MCU_CIRCULAR_CONTEXT* CircularBuf, MCU_CIRCULAR_SPAN* Span)
 {
-	uint16_t R, W;
-	uint16_t Len;
+    uint32_t W = CircularBuf->W;
+    uint32_t Len = CircularBuf->BufDepth - (W - CircularBuf->R);
+    uint32_t Pos = W & CircularBuf->Mask;
+    uint32_t First = CircularBuf->BufDepth - Pos;
 
-	R = CircularBuf->R;
-	W = CircularBuf->W;
+    /** slot given back by consumer before written */
+    __DMB();
 
-	if(R == W)
-	{
-		return 0;
-	}
-	else if(R < W)
-	{
-		Len = W - R;
-	}
-	else
-	{
-		Len = CircularBuf->BufDepth + W - R;
-	}
+    Span->Ptr[0] = (uint8_t *)&CircularBuf->CircularBuf[Pos];
+    Span->Ptr[1] = (uint8_t *)&CircularBuf->CircularBuf[0];
+    Span->Len[0] = (Len < First) ? Len : First;
+    Span->Len[1] = Len - Span->Len[0];
 
-	return Len;
+    return Len;
 }
 
-
-int32_t MCUCircular_GetData(MCU_CIRCULAR_CONTEXT* CircularBuf, void* OutBuf, uint16_t MaxLen)
+/**
+ * @brief   publish data written on reserved space
+ * @return  number of byte committed
+ */
+int32_t MCUCircular_Commit(MCU_CIRCULAR_CONTEXT* CircularBuf, uint16_t Len)
 {
-    uint16_t R;//, W;
-    uint16_t Len;
-    
+    uint32_t Space = CircularBuf->BufDepth - (CircularBuf->W - CircularBuf->R);
 
-	if(MaxLen == 0)
-	{
-		return 0;
-	}
+    if(Len > Space)
+    {
+        Len = Space;
+    }
 
-	R = CircularBuf->R;
-//	W = CircularBuf->W;
+    /** data visible before index */
+    __DMB();
+    CircularBuf->W += Len;
 
-	Len = MCUCircular_GetDataLen(CircularBuf);
+    return Len;
+}
 
-    if(Len > MaxLen)
+/**
+ * @brief   put data, never overwrite unread data
+ *          direct copy, each index read once (no span set-up)
+ * @return  number of byte written, less than Len when buffer full
+ */
+int32_t MCUCircular_PutData(MCU_CIRCULAR_CONTEXT* CircularBuf, void* InBuf, uint16_t Len)
+{
+    uint32_t W = CircularBuf->W;
+    uint32_t Space = CircularBuf->BufDepth - (W - CircularBuf->R);
+    uint32_t Pos, First;
+
+    if(Len > Space)
     {
-        Len = MaxLen;
+        Len = Space;
     }
-    
-    if(Len + R > CircularBuf->BufDepth)
+    if(Len == 0)
     {
-        memcpy(OutBuf, (void *)&CircularBuf->CircularBuf[CircularBuf->R], CircularBuf->BufDepth - CircularBuf->R);
-        memcpy((uint8_t* )OutBuf + CircularBuf->BufDepth - R, (void *)&CircularBuf->CircularBuf[0], Len + R - CircularBuf->BufDepth);
+        return 0;
+    }
+
+    /** slot given back by consumer before written */
+    __DMB();
+
+    Pos = W & CircularBuf->Mask;
+    First = CircularBuf->BufDepth - Pos;
+    if(Len <= First)
+    {
+        memcpy((void *)&CircularBuf->CircularBuf[Pos], InBuf, Len);
     }
     else
     {
-        memcpy(OutBuf, (void *)&CircularBuf->CircularBuf[CircularBuf->R], Len);
+        memcpy((void *)&CircularBuf->CircularBuf[Pos], InBuf, First);
+        memcpy((void *)&CircularBuf->CircularBuf[0], (uint8_t*)InBuf + First, Len - First);
     }
-    
-    R = (R + Len) % CircularBuf->BufDepth;
-    
-    CircularBuf->R = R;
-        
+
+    /** data visible before index */
+    __DMB();
+    CircularBuf->W = W + Len;
+
     return Len;
 }
 
+uint16_t MCUCircular_GetDataLen(MCU_CIRCULAR_CONTEXT* CircularBuf)
+{
+    return (uint16_t)(CircularBuf->W - CircularBuf->R);
+}
 
+/**
+ * @brief   copy data from read index, read index not moved
+ * @return  number of byte copied
+ */
 int32_t MCUCircular_ReadData(MCU_CIRCULAR_CONTEXT* CircularBuf, void* OutBuf, uint16_t MaxLen)
 {
-    uint16_t R;//, W;
-    uint16_t Len;
-
-
-	if(MaxLen == 0)
-	{
-		return 0;
-	}
-
-	R = CircularBuf->R;
-//	W = CircularBuf->W;
-
-	Len = MCUCircular_GetDataLen(CircularBuf);
+    MCU_CIRCULAR_SPAN Span;
+    uint16_t Len = MCUCircular_Peek(CircularBuf, &Span);
 
     if(Len > MaxLen)
     {
         Len = MaxLen;
     }
 
-    if(Len + R > CircularBuf->BufDepth)
+    if(Len <= Span.Len[0])
     {
-        memcpy(OutBuf, (void *)&CircularBuf->CircularBuf[CircularBuf->R], CircularBuf->BufDepth - CircularBuf->R);
-        memcpy((uint8_t* )OutBuf + CircularBuf->BufDepth - R, (void *)&CircularBuf->CircularBuf[0], Len + R - CircularBuf->BufDepth);
+        memcpy(OutBuf, Span.Ptr[0], Len);
     }
     else
     {
-        memcpy(OutBuf, (void *)&CircularBuf->CircularBuf[CircularBuf->R], Len);
+        memcpy(OutBuf, Span.Ptr[0], Span.Len[0]);
+        memcpy((uint8_t* )OutBuf + Span.Len[0], Span.Ptr[1], Len - Span.Len[0]);
     }
 
-//    R = (R + Len) % CircularBuf->BufDepth;
-//
-//    CircularBuf->R = R;
-
     return Len;
 }
 
-
+/**
+ * @brief   drop data from read index
+ * @return  number of byte dropped
+ */
 int32_t MCUCircular_AbortData(MCU_CIRCULAR_CONTEXT* CircularBuf, uint16_t MaxLen)
 {
-    uint16_t R;//, W;
-    uint16_t Len;
-
-
-	if(MaxLen == 0)
-	{
-		return 0;
-	}
-
-	R = CircularBuf->R;
+    return MCUCircular_Consume(CircularBuf, MaxLen);
+}
 
-	Len = MCUCircular_GetDataLen(CircularBuf);
+/**
+ * @brief   copy data from read index and consume it
+ *          direct copy, each index read once (no span set-up)
+ * @return  number of byte copied
+ */
+int32_t MCUCircular_GetData(MCU_CIRCULAR_CONTEXT* CircularBuf, void* OutBuf, uint16_t MaxLen)
+{
+    uint32_t R = CircularBuf->R;
+    uint32_t Len = CircularBuf->W - R;
+    uint32_t Pos, First;
 
     if(Len > MaxLen)
     {
         Len = MaxLen;
     }
+    if(Len == 0)
+    {
+        return 0;
+    }
 
-    R = (R + Len) % CircularBuf->BufDepth;
+    /** index read before data */
+    __DMB();
 
-    CircularBuf->R = R;
+    Pos = R & CircularBuf->Mask;
+    First = CircularBuf->BufDepth - Pos;
+    if(Len <= First)
+    {
+        memcpy(OutBuf, (void *)&CircularBuf->CircularBuf[Pos], Len);
+    }
+    else
+    {
+        memcpy(OutBuf, (void *)&CircularBuf->CircularBuf[Pos], First);
+        memcpy((uint8_t* )OutBuf + First, (void *)&CircularBuf->CircularBuf[0], Len - First);
+    }
+
+    /** data read done before slot given back to producer */
+    __DMB();
+    CircularBuf->R = R + Len;
 
     return Len;
 }
@@ -400,3 +493,240 @@ int32_t MCUDCircular_GetData2(MCU_DOUBLE_CIRCULAR_CONTEXT* CircularBuf, void* Ou
 
     return Len;
 }
+
+
+
+
+/**
+ * broadcast ring, one producer, up to MCU_MCIRCULAR_READER_MAX reader
+ * every reader see whole stream on own read index, R[] and W free running
+ * as MCU_CIRCULAR_CONTEXT, each reader single consumer of own index
+ * reader policy:
+ *   MCU_MCIRCULAR_BLOCK: producer space limited by this reader
+ *   MCU_MCIRCULAR_DROP:  producer never wait for this reader, reader lagging
+ *                        more than buffer skipped forward, lost byte counted
+ */
+
+/**
+ * @brief   config broadcast ring
+ * @param   Len buffer length, power of 2
+ * @return  0: ok
+ *          -1: Len 0 or not power of 2, rejected, buffer left with no space
+ */
+int32_t MCUMCircular_Config(MCU_MULTI_CIRCULAR_CONTEXT* CircularBuf, void* Buf, uint32_t Len, uint8_t ReaderNum)
+{
+    int32_t ret = 0;
+    uint8_t i;
+
+    if (!MCU_CIRCULAR_POW2(Len))
+    {
+        Len = 0;
+        ret = -1;
+    }
+    if (ReaderNum > MCU_MCIRCULAR_READER_MAX)
+    {
+        ReaderNum = MCU_MCIRCULAR_READER_MAX;
+    }
+
+    CircularBuf->CircularBuf = Buf;
+    CircularBuf->BufDepth = Len;
+    CircularBuf->Mask = Len - 1;
+    CircularBuf->ReaderNum = ReaderNum;
+    CircularBuf->W = 0;
+    CircularBuf->WEnd = 0;
+    for (i = 0; i < MCU_MCIRCULAR_READER_MAX; i++)
+    {
+        CircularBuf->R[i] = 0;
+        CircularBuf->Policy[i] = MCU_MCIRCULAR_BLOCK;
+        CircularBuf->Drop[i] = 0;
+    }
+
+    return ret;
+}
+
+void MCUMCircular_SetPolicy(MCU_MULTI_CIRCULAR_CONTEXT* CircularBuf, uint8_t Reader, uint8_t Policy)
+{
+    CircularBuf->Policy[Reader] = Policy;
+}
+
+/**
+ * @brief   space for producer, limited by slowest blocking reader
+ */
+int32_t MCUMCircular_GetSpaceLen(MCU_MULTI_CIRCULAR_CONTEXT* CircularBuf)
+{
+    uint32_t W = CircularBuf->W;
+    uint32_t Used = 0, Len;
+    uint8_t i;
+
+    for (i = 0; i < CircularBuf->ReaderNum; i++)
+    {
+        if (CircularBuf->Policy[i] != MCU_MCIRCULAR_BLOCK)
+            continue;
+
+        Len = W - CircularBuf->R[i];
+        if (Len > Used)
+        {
+            Used = Len;
+        }
+    }
+
+    return (CircularBuf->BufDepth - Used);
+}
+
+/**
+ * @brief   put data for all reader, never overwrite data unread by
+ *          blocking reader
+ * @return  number of byte written
+ */
+int32_t MCUMCircular_PutData(MCU_MULTI_CIRCULAR_CONTEXT* CircularBuf, void* InBuf, uint16_t Len)
+{
+    uint32_t W = CircularBuf->W;
+    uint32_t Space = MCUMCircular_GetSpaceLen(CircularBuf);
+    uint32_t Pos, First;
+
+    if(Len > Space)
+    {
+        Len = Space;
+    }
+    if(Len == 0)
+    {
+        return 0;
+    }
+
+    /** announce slot overwrite before written, see. MCUMCircular_Consume() */
+    CircularBuf->WEnd = W + Len;
+    __DMB();
+
+    Pos = W & CircularBuf->Mask;
+    First = CircularBuf->BufDepth - Pos;
+    if(Len <= First)
+    {
+        memcpy((void *)&CircularBuf->CircularBuf[Pos], InBuf, Len);
+    }
+    else
+    {
+        memcpy((void *)&CircularBuf->CircularBuf[Pos], InBuf, First);
+        memcpy((void *)&CircularBuf->CircularBuf[0], (uint8_t*)InBuf + First, Len - First);
+    }
+
+    /** data visible before index */
+    __DMB();
+    CircularBuf->W = W + Len;
+
+    return Len;
+}
+
+/**
+ * @brief   drop reader lagging more than buffer, skip to oldest valid byte
+ */
+static void MCUMCircular_CheckLag(MCU_MULTI_CIRCULAR_CONTEXT* CircularBuf, uint8_t Reader)
+{
+    uint32_t Len = CircularBuf->W - CircularBuf->R[Reader];
+
+    if(Len > CircularBuf->BufDepth)
+    {
+        CircularBuf->Drop[Reader] += Len - CircularBuf->BufDepth;
+        CircularBuf->R[Reader] = CircularBuf->W - CircularBuf->BufDepth;
+    }
+}
+
+uint16_t MCUMCircular_GetDataLen(MCU_MULTI_CIRCULAR_CONTEXT* CircularBuf, uint8_t Reader)
+{
+    MCUMCircular_CheckLag(CircularBuf, Reader);
+
+    return (uint16_t)(CircularBuf->W - CircularBuf->R[Reader]);
+}
+
+/**
+ * @brief   data of reader, in place, not consumed
+ * @note    on MCU_MCIRCULAR_DROP reader, data may be overwritten while
+ *          in use, MCUMCircular_Consume() return 0 when it happen
+ * @return  total data length
+ */
+uint16_t MCUMCircular_Peek(MCU_MULTI_CIRCULAR_CONTEXT* CircularBuf, uint8_t Reader, MCU_CIRCULAR_SPAN* Span)
+{
+    uint32_t R, Len, Pos, First;
+
+    MCUMCircular_CheckLag(CircularBuf, Reader);
+    R = CircularBuf->R[Reader];
+    Len = CircularBuf->W - R;
+    Pos = R & CircularBuf->Mask;
+    First = CircularBuf->BufDepth - Pos;
+
+    /** index read before data */
+    __DMB();
+
+    Span->Ptr[0] = (uint8_t *)&CircularBuf->CircularBuf[Pos];
+    Span->Ptr[1] = (uint8_t *)&CircularBuf->CircularBuf[0];
+    Span->Len[0] = (Len < First) ? Len : First;
+    Span->Len[1] = Len - Span->Len[0];
+
+    return Len;
+}
+
+/**
+ * @brief   move reader index after peek / read
+ * @return  number of byte consumed,
+ *          0 when data overwritten since peek / read (drop reader)
+ */
+int32_t MCUMCircular_Consume(MCU_MULTI_CIRCULAR_CONTEXT* CircularBuf, uint8_t Reader, uint16_t Len)
+{
+    uint32_t Avail;
+
+    /** data read done before index checked and given back */
+    __DMB();
+
+    /** slot overwritten (or being written) while reader on it */
+    if(CircularBuf->WEnd - CircularBuf->R[Reader] > CircularBuf->BufDepth)
+    {
+        MCUMCircular_CheckLag(CircularBuf, Reader);
+        return 0;
+    }
+
+    Avail = CircularBuf->W - CircularBuf->R[Reader];
+    if(Len > Avail)
+    {
+        Len = Avail;
+    }
+    CircularBuf->R[Reader] += Len;
+
+    return Len;
+}
+
+/**
+ * @brief   copy data of reader, reader index not moved
+ * @return  number of byte copied
+ */
+int32_t MCUMCircular_ReadData(MCU_MULTI_CIRCULAR_CONTEXT* CircularBuf, uint8_t Reader, void* OutBuf, uint16_t MaxLen)
+{
+    MCU_CIRCULAR_SPAN Span;
+    uint16_t Len = MCUMCircular_Peek(CircularBuf, Reader, &Span);
+
+    if(Len > MaxLen)
+    {
+        Len = MaxLen;
+    }
+
+    if(Len <= Span.Len[0])
+    {
+        memcpy(OutBuf, Span.Ptr[0], Len);
+    }
+    else
+    {
+        memcpy(OutBuf, Span.Ptr[0], Span.Len[0]);
+        memcpy((uint8_t* )OutBuf + Span.Len[0], Span.Ptr[1], Len - Span.Len[0]);
+    }
+
+    return Len;
+}
+
+/**
+ * @brief   copy and consume data of reader
+ * @return  number of byte, 0 when copied data overwritten (drop reader)
+ */
+int32_t MCUMCircular_GetData(MCU_MULTI_CIRCULAR_CONTEXT* CircularBuf, uint8_t Reader, void* OutBuf, uint16_t MaxLen)
+{
+    int32_t Len = MCUMCircular_ReadData(CircularBuf, Reader, OutBuf, MaxLen);
+
+    return MCUMCircular_Consume(CircularBuf, Reader, Len);
+}
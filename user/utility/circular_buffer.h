@@ -10,19 +10,35 @@ extern "C" {
 
 #include <stdint.h>
 
+/** single producer / single consumer ring, BufDepth power of 2
+ * R, W free running, buffer position is (index & Mask)
+ * length not power of 2 rejected by MCUCircular_Config()
+ */
+#define MCU_CIRCULAR_POW2(len)  (((len) != 0) && (((len) & ((len) - 1)) == 0))
+
 typedef struct __MCU_CIRCULAR_CONTEXT__
 {
-    uint32_t    R;
-    uint32_t    W;
+    volatile uint32_t   R;
+    volatile uint32_t   W;
     uint32_t    BufDepth;
+    uint32_t    Mask;
     int8_t*     CircularBuf;
 } MCU_CIRCULAR_CONTEXT;
 
-void MCUCircular_Config(MCU_CIRCULAR_CONTEXT* CircularBuf, void* Buf, uint32_t Len);
+/** in place access to ring memory, up to two contiguous span
+ * (second span used when wrap at end of buffer)
+ */
+typedef struct __MCU_CIRCULAR_SPAN__
+{
+    uint8_t*    Ptr[2];
+    uint16_t    Len[2];
+} MCU_CIRCULAR_SPAN;
+
+int32_t MCUCircular_Config(MCU_CIRCULAR_CONTEXT* CircularBuf, void* Buf, uint32_t Len);
 
 int32_t MCUCircular_GetSpaceLen(MCU_CIRCULAR_CONTEXT* CircularBuf);
 
-void MCUCircular_PutData(MCU_CIRCULAR_CONTEXT* CircularBuf, void* InBuf, uint16_t Len);
+int32_t MCUCircular_PutData(MCU_CIRCULAR_CONTEXT* CircularBuf, void* InBuf, uint16_t Len);
 
 int32_t MCUCircular_GetData(MCU_CIRCULAR_CONTEXT* CircularBuf, void* OutBuf, uint16_t MaxLen);
 
@@ -32,7 +48,18 @@ int32_t MCUCircular_AbortData(MCU_CIRCULAR_CONTEXT* CircularBuf, uint16_t MaxLen
 
 int32_t MCUCircular_ReadData(MCU_CIRCULAR_CONTEXT* CircularBuf, void* OutBuf, uint16_t MaxLen);
 
+uint16_t MCUCircular_Peek(MCU_CIRCULAR_CONTEXT* CircularBuf, MCU_CIRCULAR_SPAN* Span);
+
+int32_t MCUCircular_Consume(MCU_CIRCULAR_CONTEXT* CircularBuf, uint16_t Len);
+
+uint16_t MCUCircular_Reserve(MCU_CIRCULAR_CONTEXT* CircularBuf, MCU_CIRCULAR_SPAN* Span);
 
+int32_t MCUCircular_Commit(MCU_CIRCULAR_CONTEXT* CircularBuf, uint16_t Len);
+
+
+/** two reader ring, R2 follow R1
+ * new code use MCU_MULTI_CIRCULAR_CONTEXT
+ */
 typedef struct __MCU_DOUBLE_CIRCULAR_CONTEXT__
 {
     uint32_t    R1;
@@ -60,6 +87,45 @@ int32_t MCUDCircular_GetData2(MCU_DOUBLE_CIRCULAR_CONTEXT* CircularBuf, void* Ou
 uint16_t MCUDCircular_GetData2Len(MCU_DOUBLE_CIRCULAR_CONTEXT* CircularBuf);
 
 
+/** broadcast ring, one producer, ReaderNum reader with own index */
+#define MCU_MCIRCULAR_READER_MAX    4
+
+/** reader policy */
+#define MCU_MCIRCULAR_BLOCK         0   /** producer space limited by reader */
+#define MCU_MCIRCULAR_DROP          1   /** lagging reader skipped forward */
+
+typedef struct __MCU_MULTI_CIRCULAR_CONTEXT__
+{
+    volatile uint32_t   R[MCU_MCIRCULAR_READER_MAX];
+    volatile uint32_t   W;
+    volatile uint32_t   WEnd;   /** end of data being written, W after write */
+    uint32_t    Drop[MCU_MCIRCULAR_READER_MAX];     /** byte lost by drop reader */
+    uint8_t     Policy[MCU_MCIRCULAR_READER_MAX];
+    uint8_t     ReaderNum;
+    uint32_t    BufDepth;
+    uint32_t    Mask;
+    int8_t*     CircularBuf;
+} MCU_MULTI_CIRCULAR_CONTEXT;
+
+int32_t MCUMCircular_Config(MCU_MULTI_CIRCULAR_CONTEXT* CircularBuf, void* Buf, uint32_t Len, uint8_t ReaderNum);
+
+void MCUMCircular_SetPolicy(MCU_MULTI_CIRCULAR_CONTEXT* CircularBuf, uint8_t Reader, uint8_t Policy);
+
+int32_t MCUMCircular_GetSpaceLen(MCU_MULTI_CIRCULAR_CONTEXT* CircularBuf);
+
+int32_t MCUMCircular_PutData(MCU_MULTI_CIRCULAR_CONTEXT* CircularBuf, void* InBuf, uint16_t Len);
+
+uint16_t MCUMCircular_GetDataLen(MCU_MULTI_CIRCULAR_CONTEXT* CircularBuf, uint8_t Reader);
+
+uint16_t MCUMCircular_Peek(MCU_MULTI_CIRCULAR_CONTEXT* CircularBuf, uint8_t Reader, MCU_CIRCULAR_SPAN* Span);
+
+int32_t MCUMCircular_Consume(MCU_MULTI_CIRCULAR_CONTEXT* CircularBuf, uint8_t Reader, uint16_t Len);
+
+int32_t MCUMCircular_ReadData(MCU_MULTI_CIRCULAR_CONTEXT* CircularBuf, uint8_t Reader, void* OutBuf, uint16_t MaxLen);
+
+int32_t MCUMCircular_GetData(MCU_MULTI_CIRCULAR_CONTEXT* CircularBuf, uint8_t Reader, void* OutBuf, uint16_t MaxLen);
+
+
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,15 @@
+#ifndef CRC_H
+#define CRC_H
+
+#include <stdint.h>
+
+/** CRC-16/CCITT-FALSE initial value */
+#define CRC16_INIT      (0xFFFF)
+
+/* prototype function */
+uint8_t crc8_update(uint8_t crc, uint8_t data);
+uint8_t crc8(uint8_t crc, const uint8_t *data, uint16_t len);
+uint16_t crc16(uint16_t crc, const uint8_t *data, uint16_t len);
+/** end of prototype function */
+
+#endif /*CRC_H*/
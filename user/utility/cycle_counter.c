@@ -0,0 +1,13 @@
+#include "cycle_counter.h"
+
+/**
+ * @brief   enable DWT cycle counter, used for execution time measurement
+ *          call once on startup (see. main.c), counter free running, not
+ *          reset so start value taken by other module stay valid
+ * @return  none
+*/
+void cycle_counter_init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
@@ -0,0 +1,23 @@
+#ifndef CYCLE_COUNTER_H
+#define CYCLE_COUNTER_H
+
+#include <stdint.h>
+#include "main.h"
+
+/** core clock cycle to microsecond */
+#define CYCLE_TO_US(c)      ((c) / (SystemCoreClock / 1000000))
+
+/* prototype function */
+void cycle_counter_init(void);
+/** end of prototype function */
+
+/**
+ * @brief   get free running core cycle counter (DWT CYCCNT)
+ *          wrap every 2^32 cycle, use (now - start) for duration
+ */
+static inline uint32_t cycle_counter_get(void)
+{
+    return (DWT->CYCCNT);
+}
+
+#endif /*CYCLE_COUNTER_H*/
@@ -0,0 +1,141 @@
+#include <string.h>
+#include "event_queue.h"
+#include "main.h"
+
+/**
+ * lane index free running uint8_t, EVQ_LANE_DEPTH divide 256 so
+ * (W - R) is lane level even on index wrap
+ * post may come from several producer (interrupt and main loop), lane
+ * update done with interrupt masked, PRIMASK restored so call from
+ * interrupt or already masked section is safe
+ */
+
+/**
+ * @brief   init event queue, all lane empty, counter cleared
+ */
+void event_queue_init(EVQ_Context_t *queue)
+{
+    memset(queue, 0, sizeof(EVQ_Context_t));
+}
+
+/**
+ * @brief   set task signaled on post, call after event_queue_init()
+ */
+void event_queue_attach(EVQ_Context_t *queue, SCH_Task_t *consumer)
+{
+    queue->consumer = consumer;
+}
+
+/**
+ * @brief   post event to priority lane
+ * @param   prio see. EVQ_PRIO_xxx, out of range posted to lowest lane
+ * @return  true: queued
+ *          false: lane full, event dropped and counted
+ */
+bool event_queue_post(EVQ_Context_t *queue, uint8_t prio, const EVQ_Event_t *event)
+{
+    uint32_t primask;
+    uint8_t level;
+    bool ret = false;
+
+    if (prio >= EVQ_PRIO_NUM)
+        prio = EVQ_PRIO_LOW;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    level = (uint8_t)(queue->W[prio] - queue->R[prio]);
+    if (level < EVQ_LANE_DEPTH)
+    {
+        queue->Event[prio][queue->W[prio] & EVQ_LANE_MASK] = *event;
+        queue->W[prio]++;
+        level++;
+        if (level > queue->LevelMax[prio])
+            queue->LevelMax[prio] = level;
+        ret = true;
+    }
+    else
+    {
+        if (queue->Lost[prio] < 0xFFFF)
+            queue->Lost[prio]++;
+    }
+
+    __set_PRIMASK(primask);
+
+    if (ret && queue->consumer)
+    {
+        scheduler_signal(queue->consumer);
+    }
+
+    return ret;
+}
+
+/**
+ * @brief   get oldest event from highest priority non empty lane
+ * @note    post order kept within lane only, see. event_queue.h
+ * @return  true: event copied to *event
+ *          false: queue empty, *event untouched
+ */
+bool event_queue_get(EVQ_Context_t *queue, EVQ_Event_t *event)
+{
+    uint32_t primask;
+    uint8_t prio;
+    bool ret = false;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    for (prio = 0; prio < EVQ_PRIO_NUM; prio++)
+    {
+        if (queue->W[prio] != queue->R[prio])
+        {
+            *event = queue->Event[prio][queue->R[prio] & EVQ_LANE_MASK];
+            queue->R[prio]++;
+            ret = true;
+            break;
+        }
+    }
+
+    __set_PRIMASK(primask);
+
+    return ret;
+}
+
+/**
+ * @brief   number of pending event, all lane
+ */
+uint16_t event_queue_count(EVQ_Context_t *queue)
+{
+    uint16_t count = 0;
+    uint8_t prio;
+
+    for (prio = 0; prio < EVQ_PRIO_NUM; prio++)
+    {
+        count += (uint8_t)(queue->W[prio] - queue->R[prio]);
+    }
+
+    return count;
+}
+
+static void event_queue_timer(TW_Timer_t *timer, void *arg)
+{
+    EVQ_TimerEvent_t *tev = (EVQ_TimerEvent_t *)arg;
+
+    event_queue_post(tev->queue, tev->prio, &tev->event);
+}
+
+/**
+ * @brief   post event when timer expire, restart replace pending event
+ * @param   timeout first expiry (ms)
+ * @param   period 0: one shot, else re-post every period (ms)
+ * @note    stop with timer_wheel_stop(&tev->timer)
+ */
+void event_queue_post_on_timer(EVQ_TimerEvent_t *tev, EVQ_Context_t *queue, uint8_t prio,
+                               const EVQ_Event_t *event, uint32_t timeout, uint32_t period)
+{
+    tev->queue = queue;
+    tev->prio = prio;
+    tev->event = *event;
+
+    timer_wheel_start(&tev->timer, timeout, period, event_queue_timer, tev);
+}
@@ -0,0 +1,100 @@
+#ifndef EVENT_QUEUE_H
+#define EVENT_QUEUE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "utility/timer_wheel.h"
+#include "utility/scheduler.h"
+
+/**
+ * bounded event queue, one FIFO lane per priority
+ * get return oldest event of highest non empty lane, event on same lane
+ * delivered in post order
+ * no order kept between lane (no sequence number), event posted later on
+ * higher lane delivered first, event depending on each other order must
+ * be posted on same lane
+ * post / get safe from interrupt and main loop (short critical section)
+ * event posted to full lane dropped and counted, see. Lost[]
+ * consumer task (optional) signaled on each post, see. event_queue_attach()
+*/
+#define EVQ_LANE_DEPTH      8   // power of 2
+#define EVQ_LANE_MASK       (EVQ_LANE_DEPTH - 1)
+
+#if (EVQ_LANE_DEPTH & EVQ_LANE_MASK)
+#error "EVQ_LANE_DEPTH must be power of 2"
+#endif
+
+/** priority lane */
+enum
+{
+    EVQ_PRIO_HIGH = 0,
+    EVQ_PRIO_NORMAL,
+    EVQ_PRIO_LOW,
+    EVQ_PRIO_NUM,
+};
+
+/** payload type */
+enum
+{
+    EVQ_TYPE_NONE = 0,
+    EVQ_TYPE_U8,
+};
+
+typedef union
+{
+    uint8_t u8[4];
+    uint16_t u16[2];
+    uint32_t u32;
+} EVQ_Param_t;
+
+typedef struct
+{
+    uint16_t eventId;               // see. MessageId
+    uint8_t source;                 // event producer, application defined
+    uint8_t type;                   // payload type, see. EVQ_TYPE_xxx
+    EVQ_Param_t param;
+} EVQ_Event_t;
+
+typedef struct
+{
+    EVQ_Event_t Event[EVQ_PRIO_NUM][EVQ_LANE_DEPTH];
+    uint8_t R[EVQ_PRIO_NUM];        // free running index
+    uint8_t W[EVQ_PRIO_NUM];
+    uint16_t Lost[EVQ_PRIO_NUM];    // event dropped on full lane
+    uint8_t LevelMax[EVQ_PRIO_NUM]; // lane high water mark
+    SCH_Task_t *consumer;           // signaled on post, NULL: none
+} EVQ_Context_t;
+
+/**
+ * event posted on timer expiry, timer and event owned by caller
+ * see. event_queue_post_on_timer()
+*/
+typedef struct
+{
+    TW_Timer_t timer;
+    EVQ_Context_t *queue;
+    uint8_t prio;
+    EVQ_Event_t event;
+} EVQ_TimerEvent_t;
+
+/* prototype function */
+void event_queue_init(EVQ_Context_t *queue);
+void event_queue_attach(EVQ_Context_t *queue, SCH_Task_t *consumer);
+bool event_queue_post(EVQ_Context_t *queue, uint8_t prio, const EVQ_Event_t *event);
+bool event_queue_get(EVQ_Context_t *queue, EVQ_Event_t *event);
+uint16_t event_queue_count(EVQ_Context_t *queue);
+void event_queue_post_on_timer(EVQ_TimerEvent_t *tev, EVQ_Context_t *queue, uint8_t prio,
+                               const EVQ_Event_t *event, uint32_t timeout, uint32_t period);
+/** end of prototype function */
+
+/**
+ * @brief   post event with one byte payload
+ */
+static inline bool event_queue_post_u8(EVQ_Context_t *queue, uint8_t prio, uint16_t id, uint8_t source, uint8_t value)
+{
+    EVQ_Event_t ev = { .eventId = id, .source = source, .type = EVQ_TYPE_U8 };
+    ev.param.u8[0] = value;
+    return event_queue_post(queue, prio, &ev);
+}
+
+#endif /*EVENT_QUEUE_H*/
@@ -0,0 +1,171 @@
+#include <string.h>
+#include "low_power.h"
+#include "main.h"
+
+LP_Context_t low_power;
+
+/** SysTick count per tick (1 ms), SysTick reload restored to this after sleep */
+static uint32_t tick_load;
+/** 1: SysTick running on remainder of tick after sleep, see. low_power_tick() */
+static volatile uint8_t tick_restore;
+
+static void low_power_window(TW_Timer_t *timer, void *arg)
+{
+    uint32_t window = tick_load * LP_RESIDENCY_WINDOW;
+    uint32_t permille = (uint32_t)(((uint64_t) low_power.window_sleep * 1000) / window);
+
+    low_power.residency = (permille > 1000) ? 1000 : (uint16_t) permille;
+    low_power.wakeup = (low_power.window_wakeup > 0xFFFF) ? 0xFFFF : (uint16_t) low_power.window_wakeup;
+    low_power.window_sleep = 0;
+    low_power.window_wakeup = 0;
+}
+
+static void low_power_account(uint32_t count)
+{
+    uint32_t ms = count / tick_load;
+
+    low_power.sleep_count++;
+    low_power.window_wakeup++;
+    low_power.window_sleep += count;
+    if (ms > low_power.sleep_ms_max)
+        low_power.sleep_ms_max = ms;
+}
+
+/**
+ * @brief   init low power, call after HAL_Init() (SysTick running)
+ *          and timer_wheel_init()
+ */
+void low_power_init(void)
+{
+    memset(&low_power, 0, sizeof(low_power));
+    tick_load = SysTick->LOAD + 1;
+
+    timer_wheel_start(&low_power.window, LP_RESIDENCY_WINDOW, LP_RESIDENCY_WINDOW, low_power_window, NULL);
+}
+
+/**
+ * @brief   SysTick wrap, call from SysTick_Handler() before HAL_IncTick()
+ *          first wrap after tickless sleep end remainder of tick, 1 ms
+ *          reload taken from here (reload of the wrap itself already
+ *          latched from remainder, SysTick restarted on full tick)
+ */
+void low_power_tick(void)
+{
+    if (tick_restore)
+    {
+        tick_restore = 0;
+        SysTick->LOAD = tick_load - 1;
+        SysTick->VAL = 0;
+    }
+}
+
+/**
+ * @brief   allow SysTick suspend on long sleep
+ * @param   enable 0: keep 1 ms tick, WFI only
+ */
+void low_power_set_tickless(uint8_t enable)
+{
+    low_power.tickless = enable;
+}
+
+/**
+ * @brief   sleep until interrupt or timeout
+ * @param   timeout ms to next timer deadline (see. timer_wheel_next())
+ * @note    call with interrupt masked (PRIMASK), interrupt pending before
+ *          or during sleep end sleep, handler run when caller unmask
+ */
+void low_power_idle(uint32_t timeout)
+{
+    uint32_t before, after, reload, elapsed, ticks, remain;
+    uint32_t ticks_max = (SysTick_LOAD_RELOAD_Msk / tick_load) - 1;
+
+    if (!low_power.tickless || timeout < LP_TICKLESS_MIN)
+    {
+        /** 1 ms tick kept, SysTick interrupt end sleep at latest */
+        (void) SysTick->CTRL;   // clear COUNTFLAG
+        before = SysTick->VAL;
+        if (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk)
+            return;
+
+        __DSB();
+        __WFI();
+
+        after = SysTick->VAL;
+        elapsed = before - after;
+        if (SysTick->CTRL & SysTick_CTRL_COUNTFLAG_Msk)
+            elapsed += tick_load;
+        low_power_account(elapsed);
+        return;
+    }
+
+    /** whole tick after current one */
+    ticks = timeout - 1;
+    if (ticks > ticks_max)
+        ticks = ticks_max;
+
+    SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+    before = SysTick->VAL;  // count left on current tick
+
+    /** tick due already, let handler run */
+    if ((SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) || before < 2)
+    {
+        SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+        return;
+    }
+
+    /** expire on deadline tick boundary */
+    reload = before + (ticks * tick_load);
+    SysTick->LOAD = reload - 1;
+    SysTick->VAL = 0;
+    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+
+    __DSB();
+    __WFI();
+
+    SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+    after = SysTick->VAL;
+
+    /** reached deadline, SysTick wrapped and count again from reload */
+    if (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk)
+    {
+        SCB->ICSR = SCB_ICSR_PENDSTCLR_Msk;
+        elapsed = reload + (reload - 1 - after);
+    }
+    else
+    {
+        elapsed = reload - 1 - after;
+    }
+
+    /** tick boundary passed and count left to next boundary */
+    if (elapsed < before)
+    {
+        ticks = 0;
+        remain = before - elapsed;
+    }
+    else
+    {
+        ticks = 1 + (elapsed - before) / tick_load;
+        remain = tick_load - ((elapsed - before) % tick_load);
+    }
+
+    /** boundary too close to reload, count it now */
+    if (remain < 2)
+    {
+        ticks++;
+        remain += tick_load;
+    }
+
+    /** restart on remainder of current tick, LOAD kept till remainder
+     * expire, 1 ms reload restored on first wrap (see. low_power_tick())
+     * (few cycle lost while SysTick stopped, not compensated)
+     */
+    SysTick->LOAD = remain - 1;
+    SysTick->VAL = 0;
+    tick_restore = 1;
+    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+
+    uwTick += ticks * (uint32_t) uwTickFreq;
+
+    low_power.tickless_count++;
+    low_power_account(elapsed);
+}
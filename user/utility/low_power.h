@@ -0,0 +1,45 @@
+#ifndef LOW_POWER_H
+#define LOW_POWER_H
+
+#include <stdint.h>
+#include "utility/timer_wheel.h"
+
+/**
+ * idle sleep (WFI, sleep mode), entered from scheduler when no task ready
+ * sleep mode only, stop / standby mode never entered (clock, SysTick and
+ * peripheral kept running, UART / I2C DMA keep working while asleep)
+ * any enabled interrupt wake the core (I2C address match, USART, DMA)
+ * sleep longer than LP_TICKLESS_MIN ms suspend 1 ms SysTick interrupt:
+ * SysTick reloaded to expire on next timer deadline, tick counter
+ * (HAL_GetTick) compensated on wake by time really slept, 1 ms reload
+ * restored on first wrap, see. low_power_tick()
+ * residency measured on SysTick count, DWT cycle counter stop on sleep
+*/
+#define LP_TICKLESS_MIN         2       // ms, shorter sleep keep 1 ms tick
+#define LP_RESIDENCY_WINDOW     1000    // ms
+
+typedef struct
+{
+    uint8_t tickless;               // 1: SysTick suspended on long sleep
+    uint32_t sleep_count;           // sleep entered
+    uint32_t tickless_count;        // sleep with SysTick suspended
+    uint32_t sleep_ms_max;          // longest sleep (ms)
+
+    /** residency window, see. LP_RESIDENCY_WINDOW */
+    uint32_t window_sleep;          // SysTick count slept on current window
+    uint32_t window_wakeup;         // sleep entered on current window
+    uint16_t residency;             // sleep time on last window (permille)
+    uint16_t wakeup;                // sleep entered on last window
+    TW_Timer_t window;
+} LP_Context_t;
+
+extern LP_Context_t low_power;
+
+/* prototype function */
+void low_power_init(void);
+void low_power_set_tickless(uint8_t enable);
+void low_power_tick(void);
+void low_power_idle(uint32_t timeout);
+/** end of prototype function */
+
+#endif /*LOW_POWER_H*/
@@ -0,0 +1,172 @@
+#include <string.h>
+#include "scheduler.h"
+#include "cycle_counter.h"
+#include "low_power.h"
+#include "main.h"
+
+#define	GET_TICK()	HAL_GetTick()
+
+SCH_Context_t scheduler;
+
+/**
+ * release bookkeeping shared with interrupt (scheduler_signal), updated
+ * with interrupt masked, PRIMASK restored so call from interrupt or
+ * already masked section is safe
+ */
+static void scheduler_release(SCH_Task_t *task, uint32_t release)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    /** already pending, keep first release for jitter and deadline */
+    if (!task->ready)
+    {
+        task->release = release;
+        task->ready = 1;
+    }
+
+    __set_PRIMASK(primask);
+}
+
+static void scheduler_period(TW_Timer_t *timer, void *arg)
+{
+    /** timer re-armed before callback, nominal release one period back */
+    scheduler_release((SCH_Task_t *)arg, timer->expire - timer->period);
+}
+
+static SCH_Task_t *scheduler_get_ready(void)
+{
+    SCH_Task_t *task;
+
+    for (task = scheduler.task; task; task = task->next)
+    {
+        if (task->ready)
+            break;
+    }
+
+    return (task);
+}
+
+/**
+ * @brief   init scheduler, call after timer_wheel_init()
+ */
+void scheduler_init(void)
+{
+    memset(&scheduler, 0, sizeof(scheduler));
+}
+
+/**
+ * @brief   register task, task on same priority run in register order
+ * @param   task        task instance, owned by caller
+ * @param   run         task function, must return (run to completion)
+ * @param   arg         task argument
+ * @param   prio        see. SCH_PRIO_xxx, lower run first
+ * @param   period      release period (ms), 0: released by scheduler_signal() only
+ * @param   deadline    max ms from release to end of run, 0: not checked
+ */
+void scheduler_add(SCH_Task_t *task, sch_task_fn run, void *arg, uint8_t prio,
+                   uint32_t period, uint32_t deadline)
+{
+    SCH_Task_t **link = &scheduler.task;
+
+    memset(task, 0, sizeof(SCH_Task_t));
+    task->run = run;
+    task->arg = arg;
+    task->prio = prio;
+    task->deadline = deadline;
+
+    while (*link && (*link)->prio <= prio)
+    {
+        link = &(*link)->next;
+    }
+    task->next = *link;
+    *link = task;
+
+    scheduler_set_period(task, period);
+}
+
+/**
+ * @brief   release task (event), run on next scheduler_run()
+ *          safe from interrupt, signal while pending merged
+ */
+void scheduler_signal(SCH_Task_t *task)
+{
+    scheduler_release(task, GET_TICK());
+}
+
+/**
+ * @brief   change release period, next release one new period from now
+ * @param   period ms, 0: released by scheduler_signal() only
+ */
+void scheduler_set_period(SCH_Task_t *task, uint32_t period)
+{
+    if (period)
+    {
+        timer_wheel_start(&task->timer, period, period, scheduler_period, task);
+    }
+    else
+    {
+        timer_wheel_stop(&task->timer);
+    }
+}
+
+void scheduler_stat_reset(SCH_Task_t *task)
+{
+    task->run_count = 0;
+    task->run_cycles = 0;
+    task->run_cycles_max = 0;
+    task->jitter_max = 0;
+    task->deadline_miss = 0;
+}
+
+/**
+ * @brief   run expired timer then one ready task of highest priority,
+ *          sleep until next interrupt or timer deadline when nothing
+ *          ready (see. low_power_idle())
+ *          call at main loop
+ */
+void scheduler_run(void)
+{
+    SCH_Task_t *task;
+    uint32_t release, start, delay, next;
+
+    timer_wheel_process();
+
+    task = scheduler_get_ready();
+    if (task == 0)
+    {
+        /** check again masked, interrupt after check kept pending so
+         * WFI return at once and handler run on __enable_irq()
+         */
+        __disable_irq();
+        next = timer_wheel_next();
+        if (scheduler_get_ready() == 0 && next != 0)
+        {
+            scheduler.idle_count++;
+            low_power_idle(next);
+        }
+        __enable_irq();
+        return;
+    }
+
+    /** clear before run, signal during run release task again */
+    __disable_irq();
+    release = task->release;
+    task->ready = 0;
+    __enable_irq();
+
+    delay = GET_TICK() - release;
+    if (delay > task->jitter_max)
+        task->jitter_max = delay;
+
+    start = cycle_counter_get();
+    task->run(task->arg);
+    task->run_cycles = cycle_counter_get() - start;
+
+    if (task->run_cycles > task->run_cycles_max)
+        task->run_cycles_max = task->run_cycles;
+    task->run_count++;
+
+    if (task->deadline && (GET_TICK() - release) > task->deadline)
+        task->deadline_miss++;
+}
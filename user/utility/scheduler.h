@@ -0,0 +1,66 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdint.h>
+#include "utility/timer_wheel.h"
+
+/**
+ * cooperative run to completion scheduler
+ * task released by its period (timer wheel) and / or by scheduler_signal()
+ * (event, safe from interrupt), scheduler_run() run one ready task of
+ * highest priority per call, no ready task: core sleep until next
+ * interrupt or timer deadline (see. low_power_idle())
+ * task object owned by caller (no allocation)
+*/
+
+/** priority, lower value run first */
+enum
+{
+    SCH_PRIO_HIGH = 0,
+    SCH_PRIO_NORMAL,
+    SCH_PRIO_LOW,
+    SCH_PRIO_IDLE,
+};
+
+typedef void (*sch_task_fn)(void *arg);
+
+typedef struct _sch_task SCH_Task_t;
+
+struct _sch_task
+{
+    SCH_Task_t *next;               // registered task, priority order
+    sch_task_fn run;
+    void *arg;
+    uint8_t prio;
+    volatile uint8_t ready;
+    uint32_t release;               // tick when released (nominal tick for periodic)
+    uint32_t deadline;              // ms from release to end of run, 0: none
+    TW_Timer_t timer;               // period release
+
+    /** statistic, see. scheduler_stat_reset() */
+    uint32_t run_count;
+    uint32_t run_cycles;            // last run time (core cycle)
+    uint32_t run_cycles_max;
+    uint32_t jitter_max;            // worst start delay after release (ms)
+    uint32_t deadline_miss;
+};
+
+typedef struct
+{
+    SCH_Task_t *task;               // highest priority first
+    uint32_t idle_count;            // sleep entered, nothing ready
+} SCH_Context_t;
+
+extern SCH_Context_t scheduler;
+
+/* prototype function */
+void scheduler_init(void);
+void scheduler_add(SCH_Task_t *task, sch_task_fn run, void *arg, uint8_t prio,
+                   uint32_t period, uint32_t deadline);
+void scheduler_signal(SCH_Task_t *task);
+void scheduler_set_period(SCH_Task_t *task, uint32_t period);
+void scheduler_stat_reset(SCH_Task_t *task);
+void scheduler_run(void);
+/** end of prototype function */
+
+#endif /*SCHEDULER_H*/
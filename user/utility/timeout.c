@@ -25,13 +25,14 @@ void TimeoutSet(TIMER *timer, uint32_t timeout)
 
 /**
  * @brief   Is timer timeout
+ *          elapsed time on tick difference, safe on tick wrap (49.7 days)
  * @param   timer timer instance
  * @return  1: timeout
  *          0: no timeout (running)
 */
 bool IsTimeout(TIMER *timer)
 {
-    if (GET_TICK() >= (timer->TimeOutVal + timer->TickValCache) )
+    if ((uint32_t)(GET_TICK() - timer->TickValCache) >= timer->TimeOutVal)
     {
         return 1;
     }
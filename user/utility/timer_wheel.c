@@ -0,0 +1,222 @@
+#include "timer_wheel.h"
+#include "main.h"
+
+#define	GET_TICK()	HAL_GetTick()
+
+/** slot list head, wheel[level][slot] */
+static TW_Timer_t *wheel[TW_LEVEL][TW_SLOT];
+
+/** next tick to process, all timer before this tick already run */
+static uint32_t wheel_tick;
+
+static void timer_wheel_link(TW_Timer_t **head, TW_Timer_t *timer)
+{
+    timer->next = *head;
+    if (timer->next)
+    {
+        timer->next->pprev = &timer->next;
+    }
+    timer->pprev = head;
+    *head = timer;
+}
+
+static void timer_wheel_unlink(TW_Timer_t *timer)
+{
+    *timer->pprev = timer->next;
+    if (timer->next)
+    {
+        timer->next->pprev = timer->pprev;
+    }
+    timer->next = 0;
+    timer->pprev = 0;
+}
+
+/**
+ * @brief   put timer on slot by distance to expiry, wrap safe
+ *          (tick difference on uint32_t)
+ */
+static void timer_wheel_insert(TW_Timer_t *timer)
+{
+    uint32_t delta = timer->expire - wheel_tick;
+    uint32_t expire = timer->expire;
+    uint8_t level;
+
+    /** already due (expire before wheel_tick), run on current tick */
+    if ((int32_t) delta < 0)
+    {
+        delta = 0;
+        expire = wheel_tick;
+    }
+
+    for (level = 0; level < TW_LEVEL - 1; level++)
+    {
+        if (delta < (1UL << (TW_SLOT_BITS * (level + 1))))
+            break;
+    }
+
+    /** beyond wheel range, park on farthest slot of last level */
+    if (delta >= (1UL << (TW_SLOT_BITS * TW_LEVEL)))
+    {
+        expire = wheel_tick + (1UL << (TW_SLOT_BITS * TW_LEVEL)) - 1;
+    }
+
+    timer_wheel_link(&wheel[level][(expire >> (TW_SLOT_BITS * level)) & TW_SLOT_MASK], timer);
+}
+
+/**
+ * @brief   move timer of level slot to lower level
+ * @return  slot index
+ */
+static uint8_t timer_wheel_cascade(uint8_t level)
+{
+    uint8_t index = (wheel_tick >> (TW_SLOT_BITS * level)) & TW_SLOT_MASK;
+    TW_Timer_t *timer = wheel[level][index];
+    TW_Timer_t *next;
+
+    wheel[level][index] = 0;
+    while (timer)
+    {
+        next = timer->next;
+        timer->next = 0;
+        timer->pprev = 0;
+        timer_wheel_insert(timer);
+        timer = next;
+    }
+
+    return (index);
+}
+
+void timer_wheel_init(void)
+{
+    uint8_t level, slot;
+
+    for (level = 0; level < TW_LEVEL; level++)
+    {
+        for (slot = 0; slot < TW_SLOT; slot++)
+        {
+            wheel[level][slot] = 0;
+        }
+    }
+    wheel_tick = GET_TICK();
+}
+
+/**
+ * @brief   start (or restart) timer
+ * @param   timer       timer instance, owned by caller
+ * @param   timeout     first expiry (ms from now)
+ * @param   period      period after first expiry (ms), 0: one shot
+ * @param   callback    expiry callback
+ * @param   arg         callback argument
+ */
+void timer_wheel_start(TW_Timer_t *timer, uint32_t timeout, uint32_t period, tw_callback callback, void *arg)
+{
+    if (timer->pprev)
+    {
+        timer_wheel_unlink(timer);
+    }
+
+    timer->expire = GET_TICK() + timeout;
+    timer->period = period;
+    timer->callback = callback;
+    timer->arg = arg;
+    timer_wheel_insert(timer);
+}
+
+void timer_wheel_stop(TW_Timer_t *timer)
+{
+    if (timer->pprev)
+    {
+        timer_wheel_unlink(timer);
+    }
+}
+
+/**
+ * @brief   time to next expiry, for idle sleep
+ *          exact on level 0, upper level give time to next cascade
+ *          (never later than real expiry)
+ * @return  ms, 0: timer due, UINT32_MAX: no timer running
+ */
+uint32_t timer_wheel_next(void)
+{
+    uint32_t ahead = wheel_tick - GET_TICK();   // wheel processed beyond now
+    uint32_t next = UINT32_MAX;
+    uint32_t span, dist;
+    uint8_t level, i, index, first;
+
+    if ((int32_t) ahead < 0)
+        return (0);
+
+    for (level = 0; level < TW_LEVEL; level++)
+    {
+        span = 1UL << (TW_SLOT_BITS * level);
+        index = (wheel_tick >> (TW_SLOT_BITS * level)) & TW_SLOT_MASK;
+
+        /** upper level current slot cascaded on slot start, when already
+         * started next cascade is one round later
+         */
+        first = (level == 0 || (wheel_tick & (span - 1)) == 0) ? 0 : 1;
+        for (i = first; i < TW_SLOT + first; i++)
+        {
+            if (wheel[level][(index + i) & TW_SLOT_MASK])
+            {
+                dist = ahead + (i * span) - (wheel_tick & (span - 1));
+                if (dist < next)
+                    next = dist;
+                break;
+            }
+        }
+    }
+
+    return (next);
+}
+
+/**
+ * @brief   run expired timer, process every tick since last call
+ *          call at loop
+ */
+void timer_wheel_process(void)
+{
+    uint32_t now = GET_TICK();
+    TW_Timer_t *expired, *timer;
+    uint8_t index, level;
+
+    while ((int32_t)(now - wheel_tick) >= 0)
+    {
+        index = wheel_tick & TW_SLOT_MASK;
+
+        /** level boundary, move upper level timer down */
+        for (level = 1; index == 0 && level < TW_LEVEL; level++)
+        {
+            index = timer_wheel_cascade(level);
+        }
+        index = wheel_tick & TW_SLOT_MASK;
+
+        /** take expired list, tick moved on before callback so timer
+         * started from callback never land on slot being processed
+         */
+        expired = wheel[0][index];
+        wheel[0][index] = 0;
+        if (expired)
+        {
+            expired->pprev = &expired;
+        }
+        wheel_tick++;
+
+        while ((timer = expired) != 0)
+        {
+            timer_wheel_unlink(timer);
+
+            /** periodic timer re-armed before callback, callback may stop it */
+            if (timer->period)
+            {
+                timer->expire += timer->period;
+                timer_wheel_insert(timer);
+            }
+
+            if (timer->callback)
+            {
+                timer->callback(timer, timer->arg);
+            }
+        }
+    }
+}
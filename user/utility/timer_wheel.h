@@ -0,0 +1,53 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stdint.h>
+
+/**
+ * hierarchical timer wheel, 1 ms tick (HAL_GetTick)
+ * TW_LEVEL level of TW_SLOT slot, level n slot span TW_SLOT^n ms
+ * timeout longer than TW_SLOT^TW_LEVEL ms parked on last level and
+ * re-inserted when due
+ * timer object owned by caller (no allocation), insert / cancel O(1),
+ * timer_wheel_process() only visit expired timer
+*/
+#define TW_SLOT_BITS        5
+#define TW_SLOT             (1 << TW_SLOT_BITS)
+#define TW_SLOT_MASK        (TW_SLOT - 1)
+#define TW_LEVEL            4
+
+typedef struct _tw_timer TW_Timer_t;
+
+/**
+ * expiry callback, run from timer_wheel_process() (main loop)
+ * timer may be restarted or stopped inside callback
+ */
+typedef void (*tw_callback)(TW_Timer_t *timer, void *arg);
+
+struct _tw_timer
+{
+    TW_Timer_t *next;
+    TW_Timer_t **pprev;             // link to this timer, NULL: not running
+    uint32_t expire;                // absolute tick
+    uint32_t period;                // 0: one shot
+    tw_callback callback;
+    void *arg;
+};
+
+/* prototype function */
+void timer_wheel_init(void);
+void timer_wheel_start(TW_Timer_t *timer, uint32_t timeout, uint32_t period, tw_callback callback, void *arg);
+void timer_wheel_stop(TW_Timer_t *timer);
+uint32_t timer_wheel_next(void);
+void timer_wheel_process(void);
+/** end of prototype function */
+
+/**
+ * @brief   timer running (started and not yet expired / stopped)
+ */
+static inline uint8_t timer_wheel_is_running(const TW_Timer_t *timer)
+{
+    return (timer->pprev != 0);
+}
+
+#endif /*TIMER_WHEEL_H*/